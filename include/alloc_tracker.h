@@ -0,0 +1,32 @@
+#ifndef ALLOC_TRACKER_H
+#define ALLOC_TRACKER_H
+
+#include <cstddef>
+#include "sorting.h"
+
+// Heap accounting for the benchmark.
+//
+// alloc_tracker.cpp replaces the global operator new and delete (every form,
+// including the aligned and nothrow ones) with versions that count requested
+// bytes and allocations and keep track of the live and peak live byte
+// totals. The counters are process-wide atomics, so allocations made by the
+// pool threads of the parallel sorts are included.
+
+// Bytes currently allocated through operator new
+size_t liveHeapBytes();
+
+// Measures the heap use between its construction and stats(). Scopes must
+// not overlap, because they share the process-wide peak.
+class AllocationScope {
+public:
+    AllocationScope();
+
+    AllocationStats stats() const;
+
+private:
+    size_t startBytes;
+    size_t startCount;
+    size_t baselineLive;
+};
+
+#endif // ALLOC_TRACKER_H
@@ -0,0 +1,124 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <vector>
+#include "sorting.h"
+
+// Measurement settings of runSortingBenchmark.
+//
+// A benchmark makes warmup runs, then takes timed samples on a fresh copy of
+// the input each time. Sorts too short to time reliably are batched: one
+// sample then sorts several copies back to back and reports the time per
+// sort. Outliers are rejected with the median absolute deviation before the
+// statistics are computed.
+struct BenchmarkConfig {
+    // Untimed runs before sampling; the first also calibrates the batch size
+    // and measures memory, so at least one is always made
+    int warmupRuns = 1;
+
+    // Timed samples to take
+    int samples = 10;
+
+    // Stop sampling once this much time has been measured, after minSamples
+    int minSamples = 3;
+    double timeBudgetMs = 1000.0;
+
+    // Sorts are batched until one sample takes at least this long, as long
+    // as the batch of copies fits in batchMaxElements elements
+    double minSampleMs = 0.1;
+    size_t batchMaxElements = size_t(1) << 18;
+
+    // Samples whose modified z-score, 0.6745 * |x - median| / MAD, exceeds
+    // this are dropped as outliers
+    double outlierCutoff = 3.5;
+
+    // Compare every sorted copy against a reference sort of the input
+    bool verify = true;
+
+    // Read hardware performance counters around the timed samples
+    bool countEvents = true;
+
+    // Count comparisons, swaps and moves in one extra, untimed run on an
+    // instrumented copy of the input
+    bool countOperations = true;
+
+    // Other benchmarks run in this process at the same time, each on a
+    // thread holding a ConcurrentBenchmarkScope. The heap is measured and
+    // operations are counted while the others are paused; hardware counters,
+    // which cover every thread of the process, should be turned off.
+    bool concurrent = false;
+};
+
+// Held by every thread that runs concurrent benchmarks, for as long as it
+// runs them (it may allocate in between); scopes must not nest
+class ConcurrentBenchmarkScope {
+public:
+    ConcurrentBenchmarkScope();
+    ~ConcurrentBenchmarkScope();
+
+    ConcurrentBenchmarkScope(const ConcurrentBenchmarkScope&) = delete;
+    ConcurrentBenchmarkScope& operator=(const ConcurrentBenchmarkScope&) = delete;
+};
+
+// Working memory of runSortingBenchmark: the copies of the input the
+// algorithm sorts, and the reference they are checked against.
+//
+// A buffer passed to a series of benchmarks keeps its memory between them.
+// Memory is only allocated when a benchmark needs more than the buffer has,
+// and is written once then, so its pages are faulted in before any timed run.
+// After that, resetting a copy to the input is a single memcpy into mapped
+// memory, and every algorithm sorts at the same address. A buffer must not be
+// shared by benchmarks running at the same time.
+class BenchmarkBuffer {
+public:
+    // Make copyCount working copies of count elements each
+    void prepare(size_t copyCount, size_t count);
+
+    // Working copy i, and restoring it from the input
+    std::vector<int>& copy(size_t i) { return copies[i]; }
+    void reset(size_t i, const int* keys, size_t count);
+
+    // The input, sorted by std::sort
+    const std::vector<int>& reference() const { return sortedReference; }
+    void prepareReference(const int* keys, size_t count);
+
+    // Heap bytes held, and giving them back
+    size_t capacityBytes() const;
+    void release();
+
+private:
+    std::vector<std::vector<int>> copies;
+    std::vector<int> sortedReference;
+};
+
+// Run benchmark on a specific algorithm with the given data and settings.
+// A sort whose first run already exceeds the time budget is measured once,
+// with that run as the only sample.
+SortingResult runSortingBenchmark(
+    SortingAlgorithm& algorithm,
+    const std::vector<int>& originalData,
+    const BenchmarkConfig& config
+);
+
+// The same on count keys at keys, such as a mapped data set file
+// (dataset_file.h). The algorithm sorts one private copy of them, restored
+// from keys before every run. The overloads without a buffer use a fresh
+// one for the call.
+SortingResult runSortingBenchmark(
+    SortingAlgorithm& algorithm,
+    const int* keys,
+    size_t count,
+    const BenchmarkConfig& config
+);
+SortingResult runSortingBenchmark(
+    SortingAlgorithm& algorithm,
+    const int* keys,
+    size_t count,
+    const BenchmarkConfig& config,
+    BenchmarkBuffer& buffer
+);
+
+// Outlier rejection and summary statistics of per-sort sample times
+TimingStats summarizeSamples(std::vector<double> samplesMs, double outlierCutoff);
+
+#endif // BENCHMARK_H
@@ -0,0 +1,108 @@
+#ifndef CLI_H
+#define CLI_H
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "matrix_runner.h"
+#include "sorting.h"
+#include "utils.h"
+
+// Output formats of the command line
+enum class OutputFormat {
+    CSV,
+    JSON,
+    JSON_LINES
+};
+
+// CPU pinning of the benchmark jobs
+enum class PinMode {
+    NONE,
+    CPU,  // one logical CPU per job
+    CORE  // one physical core per job
+};
+
+// Settings of one non-interactive benchmark run
+struct BenchmarkOptions {
+    // Algorithm keys as given (see algorithmKey); empty selects every algorithm
+    std::vector<std::string> algorithms;
+    std::vector<size_t> sizes = {1000, 10000, 100000, 1000000};
+    std::vector<DataSetType> distributions = allDataSetTypes();
+    // Whether --sizes and --distributions were given; --compare only filters
+    // on the options that were
+    bool sizesGiven = false;
+    bool distributionsGiven = false;
+    // Shape of the distributions; --run-length sets runLength
+    DataSetParams dataSetParams;
+    // --data-files=LIST runs on data set files (dataset_file.h) in place of
+    // the generated sizes and distributions; --write-data=DIR writes the
+    // generated data sets to files there instead of running
+    std::vector<std::string> dataSetFiles;
+    std::string writeDataDirectory;
+    // Timed samples per cell (BenchmarkConfig::samples)
+    int repeats = 10;
+    // Untimed runs before sampling (BenchmarkConfig::warmupRuns)
+    int warmupRuns = 1;
+    // Worker threads of the parallel algorithms; 0 = hardware concurrency
+    size_t threadCount = 0;
+    // Concurrent cells and their pinning (MatrixOptions::jobs, pinThreads
+    // and physicalCoresOnly)
+    size_t jobs = 1;
+    PinMode pin = PinMode::NONE;
+    // Cell skipping (MatrixOptions::cellTimeoutMs and maxQuadraticSize)
+    double cellTimeoutSeconds = 0.0;
+    size_t maxQuadraticSize = 100000;
+    // Base seed of the data sets; drawn from std::random_device if not given
+    std::uint64_t seed = 0;
+    bool hasSeed = false;
+    // Output file; empty or "-" writes to standard output
+    std::string output;
+    OutputFormat format = OutputFormat::CSV;
+    // Append to the output file; a JSON array cannot be appended to
+    bool append = false;
+    // --compare=BASELINE,CANDIDATE compares two result files instead of
+    // running; slowdowns above thresholdPercent fail the comparison
+    std::string compareBaseline;
+    std::string compareCandidate;
+    double thresholdPercent = 5.0;
+    // --external-sort=INPUT,OUTPUT sorts a file of 32-bit keys with the one
+    // algorithm of --algorithms (default pdq) instead of running
+    // (external_sort.h)
+    std::string externalInput;
+    std::string externalOutput;
+    size_t memoryBudget = size_t(1) << 30;
+    std::string tempDirectory;
+    bool showHelp = false;
+};
+
+// Command-line key of an algorithm name: lower case, words joined by '-',
+// without a trailing "-sort" (e.g. "LSD Radix Sort" -> "lsd-radix")
+std::string algorithmKey(const std::string& name);
+
+// Parse --option=value arguments; throws std::invalid_argument on bad input
+BenchmarkOptions parseCommandLine(int argc, char* argv[]);
+
+void printUsage(std::ostream& out, const std::string& program);
+
+// Run every selected (size, distribution, algorithm) cell and write the
+// results. Progress goes to standard error so standard output can carry the
+// results. Returns the process exit code.
+int runCommandLine(const BenchmarkOptions& options, const AlgorithmFactory& factory);
+
+// Generate every selected (size, distribution) data set with the seed a run
+// would use and save it to the directory of --write-data, one file each.
+// Returns 2 when a file cannot be written, else 0.
+int writeDataSets(const BenchmarkOptions& options);
+
+// Compare the two result files of --compare and print the table (compare.h).
+// Returns 1 when a cell regressed past the threshold, 2 when a file cannot be
+// read, else 0.
+int runComparison(const BenchmarkOptions& options);
+
+// Sort the file of --external-sort and report the passes on standard error.
+// Returns 2 for a bad algorithm, budget or file, else 0.
+int runExternalSort(const BenchmarkOptions& options, const AlgorithmFactory& factory);
+
+#endif // CLI_H
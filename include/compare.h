@@ -0,0 +1,67 @@
+#ifndef COMPARE_H
+#define COMPARE_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Regression comparison of two result files.
+//
+// Result files are read in any format the benchmark has written: the CSV of
+// saveResultsToCSV and the command line, with the data set either in its own
+// columns or packed into the label ("Merge Sort [Random, n=1000]"), a JSON
+// array, or JSON Lines. Rows are matched by algorithm, distribution and n.
+//
+// The change of a cell is the ratio of the candidate's median time to the
+// baseline's. Where both rows carry a standard deviation and a sample count,
+// a 95% confidence interval is put around it: the standard error of each
+// median is taken as 1.2533 * stddev / sqrt(samples), and a Welch t
+// interval is formed on the log of the ratio.
+
+// One timed cell of a result file
+struct ResultRow {
+    std::string algorithm;
+    std::string distribution; // empty when the file did not record it
+    size_t n = 0;
+    double medianMs = 0.0;
+    double stddevMs = -1.0;   // -1 when not recorded
+    int samples = 0;
+};
+
+// Load a result file; throws std::runtime_error when it cannot be read or
+// parsed. Later rows for the same cell replace earlier ones, so an appended
+// file yields its most recent run.
+std::vector<ResultRow> loadResultRows(const std::string& path);
+
+struct Comparison {
+    ResultRow baseline;
+    ResultRow candidate;
+    double ratio = 1.0;        // candidate / baseline median time
+    double lowRatio = 1.0;     // 95% confidence interval of ratio
+    double highRatio = 1.0;
+    bool hasInterval = false;
+
+    // Slower by more than the threshold, with the interval (if any) above 1
+    bool regression = false;
+};
+
+// Which cells to compare; empty lists match everything. Algorithms are
+// command-line keys (algorithmKey), distributions display names.
+struct CompareFilter {
+    std::vector<std::string> algorithms;
+    std::vector<std::string> distributions;
+    std::vector<size_t> sizes;
+};
+
+// Compare the cells present in both sets, in baseline order
+std::vector<Comparison> compareResults(
+    const std::vector<ResultRow>& baseline,
+    const std::vector<ResultRow>& candidate,
+    const CompareFilter& filter,
+    double thresholdPercent
+);
+
+// Print a comparison table and a summary line
+void printComparison(std::ostream& out, const std::vector<Comparison>& comparisons, double thresholdPercent);
+
+#endif // COMPARE_H
@@ -0,0 +1,76 @@
+#ifndef DATASET_FILE_H
+#define DATASET_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Binary data set files, so benchmarks can run on keys captured elsewhere,
+// such as production key dumps, and large generated data sets are written
+// once instead of regenerated for every run.
+//
+// A file is a 64-byte header followed by the keys in native byte order:
+//
+//   offset  size  field
+//        0     8  magic "SORTDATA"
+//        8     4  format version, 1
+//       12     4  element type (DataSetElementType)
+//       16     8  element count
+//       24     8  seed the keys were generated with
+//       32     4  flags: 1 = the seed is recorded
+//       36     4  reserved, 0
+//       40    24  distribution: a data set key such as "zipf" (dataSetKey),
+//                 or any label for captured keys; NUL padded
+//
+// Files are read through a read-only mapping, so opening one costs no copy
+// and the keys start on a cache-line boundary.
+
+enum class DataSetElementType : std::uint32_t {
+    INT32 = 1
+};
+
+// What the header of a data set file records
+struct DataSetFileInfo {
+    DataSetElementType elementType = DataSetElementType::INT32;
+    std::uint64_t count = 0;
+    std::uint64_t seed = 0;
+    bool hasSeed = false;
+    std::string distribution;
+};
+
+// Write keys with a header (info.count is taken from keys). Throws
+// std::invalid_argument for a distribution longer than 23 characters and
+// std::runtime_error when the file cannot be written.
+void saveDataSetFile(const std::string& path, const std::vector<int>& keys, const DataSetFileInfo& info);
+
+// Read and check the header of a data set file; throws std::runtime_error
+// when the file cannot be read, is not a data set file, has an unsupported
+// element type, or is shorter than its header says
+DataSetFileInfo readDataSetFileInfo(const std::string& path);
+
+// A data set file mapped read-only into memory (read into memory where
+// mmap is unavailable). The keys are shared with the page cache: nothing is
+// copied until a benchmark copies them into its working buffer.
+class MappedDataSet {
+public:
+    // Throws std::runtime_error as readDataSetFileInfo does
+    explicit MappedDataSet(const std::string& path);
+    ~MappedDataSet();
+
+    MappedDataSet(const MappedDataSet&) = delete;
+    MappedDataSet& operator=(const MappedDataSet&) = delete;
+
+    const DataSetFileInfo& info() const { return fileInfo; }
+    const int* data() const { return keys; }
+    size_t size() const { return static_cast<size_t>(fileInfo.count); }
+
+private:
+    DataSetFileInfo fileInfo;
+    const int* keys = nullptr;
+    void* mapping = nullptr;
+    size_t mappingBytes = 0;
+    std::vector<int> fallback;
+};
+
+#endif // DATASET_FILE_H
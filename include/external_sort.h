@@ -0,0 +1,50 @@
+#ifndef EXTERNAL_SORT_H
+#define EXTERNAL_SORT_H
+
+#include <cstddef>
+#include <string>
+#include "sorting.h"
+
+// External-memory sort of a file of 32-bit keys (native byte order, no
+// header) that may be far larger than RAM.
+//
+// The input is read in chunks as large as the memory budget allows, each
+// chunk is sorted by a SortingAlgorithm and spilled to a temporary run file.
+// A loser tree (loser_tree.h) then merges the runs into the output. Every run
+// and the output stream through two buffers, so a background thread reads
+// the next block of each run, or writes the last block of output, while the
+// merge works on the other. When there are more runs than the budget has
+// buffers for, groups of them are merged into longer runs first.
+
+struct ExternalSortOptions {
+    // Bytes of RAM for the chunk being sorted, including the algorithm's
+    // scratch space, and for the merge buffers
+    std::size_t memoryBudget = std::size_t(1) << 30;
+
+    // Where runs are spilled; empty uses the directory of the output file
+    std::string tempDirectory;
+};
+
+struct ExternalSortStats {
+    std::size_t elements = 0;
+    std::size_t chunkElements = 0;  // elements sorted in memory at a time
+    std::size_t runs = 0;           // runs written by the first pass
+    std::size_t fanIn = 0;          // runs merged at once
+    std::size_t mergePasses = 0;    // 0 when the input fit in one chunk
+    std::size_t bufferBytes = 0;    // size of each merge buffer
+    double runFormationMs = 0.0;    // reading, sorting and spilling chunks
+    double mergeMs = 0.0;
+};
+
+// Sort inputPath into outputPath with algorithm; temporary runs are removed
+// when done. Throws std::invalid_argument for a budget too small to sort in
+// or an input that is not a whole number of keys, and std::runtime_error
+// when a file cannot be read or written.
+ExternalSortStats externalSort(
+    const std::string& inputPath,
+    const std::string& outputPath,
+    SortingAlgorithm& algorithm,
+    const ExternalSortOptions& options
+);
+
+#endif // EXTERNAL_SORT_H
@@ -0,0 +1,178 @@
+#ifndef LOSER_TREE_H
+#define LOSER_TREE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Tournament (loser) tree over k sorted runs, and the k-way merge built on it.
+//
+// Every inner node keeps the run that lost the match played there, and the
+// overall winner is kept apart. Advancing the winner replays only the matches
+// on its leaf's path, each against the stored loser: one pass up the tree
+// and one match per level, where a winner tree also has to look at every
+// sibling. Runs are told apart by index, not by sentinel keys, and ties go
+// to the lower run index, so merging is stable.
+namespace sorting {
+
+template <typename InputIt, typename Compare = std::less<>>
+class LoserTree {
+public:
+    using Run = std::pair<InputIt, InputIt>;
+    using Value = typename std::iterator_traits<InputIt>::value_type;
+
+    explicit LoserTree(std::vector<Run> runs, Compare comp = Compare())
+        : runs_(std::move(runs)), tree_(std::max<std::size_t>(runs_.size(), 1)), comp_(comp) {
+        if (runs_.size() > UINT32_MAX) {
+            throw std::invalid_argument("a loser tree holds at most 2^32 - 1 runs");
+        }
+        for (const Run& run : runs_) {
+            if (run.first != run.second) active_++;
+        }
+        if (!runs_.empty()) {
+            tree_[0] = play(1);
+        }
+    }
+
+    // Whether every run is exhausted
+    bool empty() const { return active_ == 0; }
+
+    // Runs that still have elements
+    std::size_t activeRuns() const { return active_; }
+
+    // Index of the run holding the smallest element
+    std::size_t winner() const { return tree_[0].run; }
+
+    // The smallest element (through the run's iterator, so a move_iterator
+    // run hands it out as an rvalue)
+    decltype(auto) top() const { return *runs_[tree_[0].run].first; }
+
+    // Remaining range of a run
+    const Run& run(std::size_t index) const { return runs_[index]; }
+
+    // Advance the winning run and replay its path
+    void pop() {
+        std::size_t index = tree_[0].run;
+        ++runs_[index].first;
+        Player w = player(index);
+        if (!w.live) active_--;
+
+        for (std::size_t node = (w.run + runs_.size()) / 2; node > 0; node /= 2) {
+            if (beats(tree_[node], w)) {
+                std::swap(tree_[node], w);
+            }
+        }
+        tree_[0] = w;
+    }
+
+private:
+    // Small trivially copyable keys are copied into the tree, so a match
+    // compares registers; other keys are compared through their address
+    static constexpr bool COPY_KEYS = std::is_trivially_copyable<Value>::value && sizeof(Value) <= sizeof(void*);
+    using Key = typename std::conditional<COPY_KEYS, Value, const Value*>::type;
+
+    // A run and its head, which is all a match looks at, so replaying a path
+    // reads the tree but not the runs. Run indices are 32 bits, which keeps
+    // a player of int keys at 12 bytes.
+    struct Player {
+        Key key{};
+        std::uint32_t run = 0;
+        bool live = false; // false once the run is exhausted
+    };
+
+    std::vector<Run> runs_;
+    // tree_[0] is the winner, tree_[1..k) the losers of the inner nodes;
+    // run i is the leaf k + i
+    std::vector<Player> tree_;
+    Compare comp_;
+    std::size_t active_ = 0;
+
+    // The runs' iterators must dereference to references, as those of
+    // containers do, so a key's address outlives the expression
+    Player player(std::size_t index) const {
+        Player p;
+        p.run = static_cast<std::uint32_t>(index);
+        const Run& run = runs_[index];
+        if (run.first != run.second) {
+            const Value& key = *run.first;
+            if constexpr (COPY_KEYS) {
+                p.key = key;
+            } else {
+                p.key = std::addressof(key);
+            }
+            p.live = true;
+        }
+        return p;
+    }
+
+    // Whether a's head comes before b's; exhausted runs lose
+    bool beats(const Player& a, const Player& b) const {
+        if (!a.live) return false;
+        if (!b.live) return true;
+
+        // On equal keys the lower run wins. Testing a < b first settles most
+        // matches with one comparison, and branches on it measured well
+        // ahead of selecting the operands with conditional moves, whose
+        // chain the next match has to wait for.
+        const Value& keyA = keyOf(a);
+        const Value& keyB = keyOf(b);
+        if (comp_(keyA, keyB)) return true;
+        if (comp_(keyB, keyA)) return false;
+        return a.run < b.run;
+    }
+
+    static const Value& keyOf(const Player& p) {
+        if constexpr (COPY_KEYS) {
+            return p.key;
+        } else {
+            return *p.key;
+        }
+    }
+
+    // Play the subtree under node and return its winner
+    Player play(std::size_t node) {
+        std::size_t k = runs_.size();
+        if (node >= k) {
+            return player(node - k);
+        }
+
+        Player left = play(2 * node);
+        Player right = play(2 * node + 1);
+        if (beats(left, right)) {
+            tree_[node] = right;
+            return left;
+        }
+        tree_[node] = left;
+        return right;
+    }
+};
+
+// Merge sorted runs into out and return the end of the output. Elements are
+// assigned from the runs' iterators, so runs of move_iterators are moved.
+template <typename InputIt, typename OutputIt, typename Compare = std::less<>>
+OutputIt mergeRuns(std::vector<std::pair<InputIt, InputIt>> runs, OutputIt out, Compare comp = Compare()) {
+    LoserTree<InputIt, Compare> tree(std::move(runs), comp);
+    while (tree.activeRuns() > 1) {
+        *out = tree.top();
+        ++out;
+        tree.pop();
+    }
+
+    // The last run needs no more matches
+    if (!tree.empty()) {
+        const auto& last = tree.run(tree.winner());
+        out = std::copy(last.first, last.second, out);
+    }
+    return out;
+}
+
+} // namespace sorting
+
+#endif // LOSER_TREE_H
@@ -0,0 +1,83 @@
+#ifndef MATRIX_RUNNER_H
+#define MATRIX_RUNNER_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "benchmark.h"
+#include "sorting.h"
+#include "utils.h"
+
+// Runs the benchmark matrix: every (size, distribution, algorithm) cell.
+//
+// The cells of one algorithm and distribution form a chain that runs its
+// sizes in ascending order, so a cell can be skipped when the chain's
+// previous cell predicts that one sort would exceed the cell timeout. Chains of
+// single-threaded algorithms run concurrently on `jobs` worker threads, each
+// with its own algorithm instances and optionally pinned to its own CPU.
+// Algorithms that sort on several threads run afterwards, one cell at a
+// time, so they get the whole machine.
+
+// Creates a fresh instance of every algorithm; threadCount sizes the pools
+// of the parallel ones (0 = one thread per hardware thread)
+using AlgorithmFactory = std::function<std::vector<std::unique_ptr<SortingAlgorithm>>(size_t threadCount)>;
+
+struct MatrixOptions {
+    std::vector<size_t> sizes = {1000, 10000, 100000, 1000000};
+    std::vector<DataSetType> distributions = allDataSetTypes();
+    DataSetParams dataSetParams;
+
+    // Data set files (dataset_file.h) to run on instead of generating the
+    // sizes and distributions above; each file is one cell per algorithm
+    std::vector<std::string> dataSetFiles;
+
+    // Indices into the factory's algorithms; empty selects all of them
+    std::vector<size_t> algorithms;
+
+    // Threads of the parallel algorithms, passed to the factory
+    size_t threadCount = 0;
+
+    // Base seed; each data set's seed is derived from it (dataSetSeed)
+    std::uint64_t seed = 0;
+
+    BenchmarkConfig config;
+
+    // Cells of single-threaded algorithms run at the same time; 0 runs one
+    // per usable CPU (or physical core)
+    size_t jobs = 1;
+
+    // Pin each worker to its own CPU with sched_setaffinity (Linux only)
+    bool pinThreads = false;
+
+    // Use one logical CPU per physical core, leaving SMT siblings idle
+    bool physicalCoresOnly = false;
+
+    // Skip a cell when extrapolating the chain's previous cell predicts one
+    // sort would take longer than this (a cell makes several); 0 = never
+    double cellTimeoutMs = 0.0;
+
+    // Skip algorithms with quadratic average case above this size; 0 = never
+    size_t maxQuadraticSize = 0;
+};
+
+// Seed of one data set, derived from the base seed so that a data set does not
+// change when other sizes or distributions are added to the run
+std::uint64_t dataSetSeed(std::uint64_t seed, size_t size, DataSetType type);
+
+// Logical CPUs this process may run on, restricted to the first CPU of every
+// physical core when physicalCoresOnly is set. Empty where unsupported.
+std::vector<int> usableCpus(bool physicalCoresOnly);
+
+// Run every cell and return the results in size, distribution, algorithm
+// order; skipped cells have no result. Progress and skips are reported on
+// progress.
+std::vector<SortingResult> runBenchmarkMatrix(
+    const MatrixOptions& options,
+    const AlgorithmFactory& factory,
+    std::ostream& progress
+);
+
+#endif // MATRIX_RUNNER_H
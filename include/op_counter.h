@@ -0,0 +1,106 @@
+#ifndef OP_COUNTER_H
+#define OP_COUNTER_H
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "sorting.h"
+
+// Operation counting for the comparison sorts.
+//
+// Counts come from a separate run of the templated algorithm on Counted<int>
+// elements, never from the timed runs, so instrumentation costs the
+// benchmarks nothing. Building with -DSORTING_COUNT_OPERATIONS=0 (make
+// COUNT_OPERATIONS=0) removes the instrumented instantiations altogether.
+//
+// Counted<int> is not an int, so the SIMD sorting and merging networks do
+// not apply: the counts are those of the scalar algorithm.
+#ifndef SORTING_COUNT_OPERATIONS
+#define SORTING_COUNT_OPERATIONS 1
+#endif
+
+namespace sorting {
+
+namespace detail {
+
+// Shared by every thread, so the parallel sorts are counted too
+inline std::atomic<std::uint64_t> comparisonCount{0};
+inline std::atomic<std::uint64_t> swapCount{0};
+inline std::atomic<std::uint64_t> moveCount{0};
+
+inline void countOne(std::atomic<std::uint64_t>& counter) {
+    counter.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace detail
+
+// Element wrapper that counts its comparisons, copies and moves. A swap found
+// through ADL, as std::iter_swap and the sorts do, counts as one swap rather
+// than three moves.
+template <typename T>
+class Counted {
+public:
+    Counted() = default;
+    Counted(const T& value) : value(value) {}
+
+    Counted(const Counted& other) : value(other.value) { detail::countOne(detail::moveCount); }
+    Counted(Counted&& other) noexcept : value(std::move(other.value)) { detail::countOne(detail::moveCount); }
+
+    Counted& operator=(const Counted& other) {
+        detail::countOne(detail::moveCount);
+        value = other.value;
+        return *this;
+    }
+
+    Counted& operator=(Counted&& other) noexcept {
+        detail::countOne(detail::moveCount);
+        value = std::move(other.value);
+        return *this;
+    }
+
+    const T& get() const { return value; }
+
+    friend bool operator<(const Counted& a, const Counted& b) {
+        detail::countOne(detail::comparisonCount);
+        return a.value < b.value;
+    }
+
+    friend void swap(Counted& a, Counted& b) noexcept {
+        detail::countOne(detail::swapCount);
+        using std::swap;
+        swap(a.value, b.value);
+    }
+
+private:
+    T value{};
+};
+
+// Run sortFn(first, last) on a Counted copy of data and return what it did.
+// The counts are only meaningful while no other counted sort runs.
+template <typename SortFn>
+OperationCounts countOperations(const std::vector<int>& data, SortFn sortFn) {
+    OperationCounts counts;
+#if SORTING_COUNT_OPERATIONS
+    std::vector<Counted<int>> elements(data.begin(), data.end());
+
+    detail::comparisonCount.store(0, std::memory_order_relaxed);
+    detail::swapCount.store(0, std::memory_order_relaxed);
+    detail::moveCount.store(0, std::memory_order_relaxed);
+
+    sortFn(elements.begin(), elements.end());
+
+    counts.comparisons = detail::comparisonCount.load(std::memory_order_relaxed);
+    counts.swaps = detail::swapCount.load(std::memory_order_relaxed);
+    counts.moves = detail::moveCount.load(std::memory_order_relaxed);
+    counts.counted = true;
+#else
+    (void)data;
+    (void)sortFn;
+#endif
+    return counts;
+}
+
+} // namespace sorting
+
+#endif // OP_COUNTER_H
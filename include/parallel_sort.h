@@ -0,0 +1,333 @@
+#ifndef PARALLEL_SORT_H
+#define PARALLEL_SORT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "radix_sort.h"
+#include "sort_algorithms.h"
+#include "sort_workspace.h"
+#include "thread_pool.h"
+
+// Parallel counterparts of the templated sorts in sort_algorithms.h and
+// radix_sort.h.
+// They run fork-join on a ThreadPool and fall back to the sequential
+// algorithm once a piece of work is below its grain size.
+namespace sorting {
+
+namespace detail {
+
+// Merges shorter than this are done sequentially
+constexpr std::ptrdiff_t PARALLEL_MERGE_GRAIN = 1 << 13;
+
+// Smallest piece of input a parallel sort hands to its sequential version
+constexpr std::ptrdiff_t PARALLEL_SORT_MIN_GRAIN = 1 << 12;
+
+// Stable merge of [first1, first1 + n1) and [first2, first2 + n2) into out.
+// Large merges are split in two by binary search: the median of the longer
+// run fixes its split point, and its rank in the other run fixes the other.
+// Both halves are then merged independently.
+template <typename InIt, typename OutIt, typename Compare>
+void parallelMerge(InIt first1, std::ptrdiff_t n1, InIt first2, std::ptrdiff_t n2, OutIt out,
+                   ThreadPool& pool, Compare comp) {
+    if (n1 + n2 <= PARALLEL_MERGE_GRAIN) {
+        mergeInto(first1, first1 + n1, first2, first2 + n2, out, comp);
+        return;
+    }
+
+    std::ptrdiff_t m1;
+    std::ptrdiff_t m2;
+    if (n1 >= n2) {
+        // Elements of run2 equal to the split key go right, after it
+        m1 = n1 / 2;
+        m2 = std::lower_bound(first2, first2 + n2, first1[m1], comp) - first2;
+    } else {
+        // Elements of run1 equal to the split key go left, before it
+        m2 = n2 / 2;
+        m1 = std::upper_bound(first1, first1 + n1, first2[m2], comp) - first1;
+    }
+
+    TaskGroup group(pool);
+    group.run([=, &pool] {
+        parallelMerge(first1, m1, first2, m2, out, pool, comp);
+    });
+    parallelMerge(first1 + m1, n1 - m1, first2 + m2, n2 - m2, out + m1 + m2, pool, comp);
+    group.wait();
+}
+
+// Parallel version of mergeSortPingPong. Only the input array holds data on
+// entry, so each leaf first copies its slice to the other buffer;
+// srcHoldsInput says which side that is at this depth.
+template <typename DstIt, typename SrcIt, typename Compare>
+void parallelMergeSortPingPong(DstIt dst, SrcIt src, std::ptrdiff_t n, bool srcHoldsInput,
+                               std::ptrdiff_t grain, ThreadPool& pool, Compare comp) {
+    if (n <= grain) {
+        if (srcHoldsInput)
+            std::copy(src, src + n, dst);
+        else
+            std::copy(dst, dst + n, src);
+        mergeSortPingPong(dst, src, n, comp);
+        return;
+    }
+
+    std::ptrdiff_t mid = n / 2;
+
+    TaskGroup group(pool);
+    group.run([=, &pool] {
+        parallelMergeSortPingPong(src, dst, mid, !srcHoldsInput, grain, pool, comp);
+    });
+    parallelMergeSortPingPong(src + mid, dst + mid, n - mid, !srcHoldsInput, grain, pool, comp);
+    group.wait();
+
+    if (!comp(src[mid], src[mid - 1])) {
+        std::move(src, src + n, dst);
+        return;
+    }
+
+    parallelMerge(src, mid, src + mid, n - mid, dst, pool, comp);
+}
+
+// Introsort loop that hands one side of every partition larger than grain
+// to the pool and keeps the other, so independent partitions sort in parallel
+template <typename RandomIt, typename Compare>
+void parallelIntrosortLoop(RandomIt first, RandomIt last, int depthLimit, std::ptrdiff_t grain,
+                           ThreadPool& pool, Compare comp) {
+    TaskGroup group(pool);
+
+    while (last - first > grain) {
+        if (depthLimit == 0) {
+            heapSort(first, last, comp);
+            group.wait();
+            return;
+        }
+        depthLimit--;
+
+        choosePivot(first, last, comp);
+        RandomIt cut = hoarePartition(first, last, comp);
+
+        // Fork the smaller side and keep partitioning the larger one
+        if (cut - first < last - cut) {
+            group.run([=, &pool] {
+                parallelIntrosortLoop(first, cut, depthLimit, grain, pool, comp);
+            });
+            first = cut;
+        } else {
+            group.run([=, &pool] {
+                parallelIntrosortLoop(cut, last, depthLimit, grain, pool, comp);
+            });
+            last = cut;
+        }
+    }
+
+    introsortLoop(first, last, depthLimit, comp);
+    group.wait();
+}
+
+// Staging line of one bucket in the parallel LSD scatter: a cache line of
+// elements, aligned like the lines of the destination it mirrors
+template <typename T>
+struct alignas(64) RadixStagingLine {
+    static constexpr unsigned SIZE = sizeof(T) >= 64 ? 1u : static_cast<unsigned>(64 / sizeof(T));
+    T slots[SIZE];
+};
+
+// Position of address within its cache line, in elements; 0 for elements
+// that do not tile a line
+template <typename T>
+unsigned lineSlot(const T* address) {
+    if constexpr (sizeof(T) < 64 && 64 % sizeof(T) == 0) {
+        return static_cast<unsigned>((reinterpret_cast<std::uintptr_t>(address) % 64) / sizeof(T));
+    } else {
+        return 0;
+    }
+}
+
+// One parallel LSD pass reads its chunk and scatters it to dst at offsets.
+// Elements are staged in a line per bucket, in the slot they will occupy in
+// their destination line, and a line is flushed when it reaches the end of
+// that line. A bucket's first flush fills the rest of the line it starts in,
+// and every later one writes a whole, aligned cache line, instead of each
+// element touching a random line.
+template <int DigitBits, typename T>
+void radixScatterChunk(const T* src, std::ptrdiff_t begin, std::ptrdiff_t end, T* dst, int shift,
+                       std::size_t* offsets, RadixStagingLine<T>* staging, unsigned* fill) {
+    constexpr std::size_t RADIX = std::size_t(1) << DigitBits;
+    constexpr unsigned LINE = RadixStagingLine<T>::SIZE;
+
+    for (std::size_t d = 0; d < RADIX; d++) {
+        fill[d] = lineSlot(dst + offsets[d]);
+    }
+
+    for (std::ptrdiff_t i = begin; i < end; i++) {
+        std::size_t d = radixDigit<DigitBits>(src[i], shift);
+        T* line = staging[d].slots;
+        line[fill[d]++] = src[i];
+
+        if (fill[d] == LINE) {
+            unsigned start = lineSlot(dst + offsets[d]);
+            std::copy(line + start, line + LINE, dst + offsets[d]);
+            offsets[d] += LINE - start;
+            fill[d] = 0;
+        }
+    }
+
+    // Flush the partly filled lines
+    for (std::size_t d = 0; d < RADIX; d++) {
+        T* line = staging[d].slots;
+        unsigned start = lineSlot(dst + offsets[d]);
+        std::copy(line + start, line + fill[d], dst + offsets[d]);
+        offsets[d] += fill[d] - start;
+    }
+}
+
+} // namespace detail
+
+// Stable parallel merge sort. Recursive halves are forked onto the pool down
+// to a grain size that leaves a few tasks per thread, and the merges above
+// that are split by binary search so the top levels are parallel too.
+template <typename RandomIt, typename Compare = std::less<>>
+void parallelMergeSort(RandomIt first, RandomIt last, ThreadPool& pool,
+                       SortWorkspace<ValueType<RandomIt>>& workspace, Compare comp = Compare()) {
+    std::ptrdiff_t n = last - first;
+    if (n < 2) return;
+
+    std::ptrdiff_t threads = static_cast<std::ptrdiff_t>(pool.size());
+    std::ptrdiff_t grain = std::max(detail::PARALLEL_SORT_MIN_GRAIN, n / (8 * threads));
+
+    if (n <= grain) {
+        mergeSort(first, last, workspace, comp);
+        return;
+    }
+
+    workspace.reserve(static_cast<std::size_t>(n));
+    detail::parallelMergeSortPingPong(first, workspace.data(), n, false, grain, pool, comp);
+}
+
+template <typename RandomIt, typename Compare = std::less<>>
+void parallelMergeSort(RandomIt first, RandomIt last, ThreadPool& pool, Compare comp = Compare()) {
+    SortWorkspace<ValueType<RandomIt>> workspace;
+    parallelMergeSort(first, last, pool, workspace, comp);
+}
+
+// Parallel introsort. Partitions larger than the grain size are split and
+// their halves sorted as separate tasks; the depth limit and heap sort
+// fallback of quickSort still bound the worst case.
+template <typename RandomIt, typename Compare = std::less<>>
+void parallelQuickSort(RandomIt first, RandomIt last, ThreadPool& pool, Compare comp = Compare()) {
+    std::ptrdiff_t n = last - first;
+    if (n < 2) return;
+
+    std::ptrdiff_t threads = static_cast<std::ptrdiff_t>(pool.size());
+    std::ptrdiff_t grain = std::max(detail::PARALLEL_SORT_MIN_GRAIN, n / (8 * threads));
+
+    detail::parallelIntrosortLoop(first, last, detail::introsortDepthLimit(n), grain, pool, comp);
+}
+
+// Parallel LSD radix sort. The input is split into one chunk per thread.
+// Every pass, each thread histograms its chunk; a prefix sum over the
+// per-thread histograms (bucket-major, then thread order) gives each thread
+// private scatter offsets, so all threads scatter into the double buffer at
+// once without synchronization and the sort stays stable. The range must be
+// contiguous in memory.
+template <int DigitBits = 8, typename RandomIt>
+void parallelLsdRadixSort(RandomIt first, RandomIt last, ThreadPool& pool,
+                          SortWorkspace<ValueType<RandomIt>>& workspace) {
+    using T = ValueType<RandomIt>;
+    static_assert(DigitBits > 0 && DigitBits <= 16, "digit width must be between 1 and 16 bits");
+
+    constexpr std::size_t RADIX = std::size_t(1) << DigitBits;
+    constexpr int PASSES = (RadixKey<T>::BITS + DigitBits - 1) / DigitBits;
+
+    std::ptrdiff_t n = last - first;
+    std::ptrdiff_t chunks = std::min(static_cast<std::ptrdiff_t>(pool.size()),
+                                     n / detail::PARALLEL_SORT_MIN_GRAIN);
+    if (chunks < 2) {
+        lsdRadixSort<DigitBits>(first, last, workspace);
+        return;
+    }
+
+    auto chunkBegin = [n, chunks](std::ptrdiff_t c) { return n * c / chunks; };
+
+    workspace.reserve(static_cast<std::size_t>(n));
+    T* data = &*first;
+    T* src = data;
+    T* dst = workspace.data();
+
+    // Per-chunk histograms (turned into offsets in place) and staging lines,
+    // which the over-aligned element type keeps on cache-line boundaries
+    std::vector<std::size_t> counts(chunks * RADIX);
+    std::vector<detail::RadixStagingLine<T>> staging(chunks * RADIX);
+    std::vector<unsigned> fill(chunks * RADIX);
+
+    for (int pass = 0; pass < PASSES; pass++) {
+        int shift = pass * DigitBits;
+
+        {
+            TaskGroup group(pool);
+            for (std::ptrdiff_t c = 0; c < chunks; c++) {
+                group.run([&, c] {
+                    std::size_t* count = &counts[c * RADIX];
+                    std::fill(count, count + RADIX, 0);
+                    for (std::ptrdiff_t i = chunkBegin(c); i < chunkBegin(c + 1); i++) {
+                        count[detail::radixDigit<DigitBits>(src[i], shift)]++;
+                    }
+                });
+            }
+            group.wait();
+        }
+
+        // Bucket b of chunk c starts after all smaller buckets, and after
+        // bucket b of every earlier chunk
+        std::size_t offset = 0;
+        bool trivial = false;
+        for (std::size_t b = 0; b < RADIX && !trivial; b++) {
+            std::size_t bucketStart = offset;
+            for (std::ptrdiff_t c = 0; c < chunks; c++) {
+                std::size_t count = counts[c * RADIX + b];
+                counts[c * RADIX + b] = offset;
+                offset += count;
+            }
+            trivial = offset - bucketStart == static_cast<std::size_t>(n);
+        }
+
+        // Every key shares this digit: nothing would move
+        if (trivial) continue;
+
+        {
+            TaskGroup group(pool);
+            for (std::ptrdiff_t c = 0; c < chunks; c++) {
+                group.run([&, c] {
+                    detail::radixScatterChunk<DigitBits>(src, chunkBegin(c), chunkBegin(c + 1), dst, shift,
+                                                         &counts[c * RADIX], &staging[c * RADIX],
+                                                         &fill[c * RADIX]);
+                });
+            }
+            group.wait();
+        }
+
+        std::swap(src, dst);
+    }
+
+    // An odd number of passes leaves the result in the workspace
+    if (src != data) {
+        TaskGroup group(pool);
+        for (std::ptrdiff_t c = 0; c < chunks; c++) {
+            group.run([&, c] {
+                std::copy(src + chunkBegin(c), src + chunkBegin(c + 1), data + chunkBegin(c));
+            });
+        }
+        group.wait();
+    }
+}
+
+template <int DigitBits = 8, typename RandomIt>
+void parallelLsdRadixSort(RandomIt first, RandomIt last, ThreadPool& pool) {
+    SortWorkspace<ValueType<RandomIt>> workspace;
+    parallelLsdRadixSort<DigitBits>(first, last, pool, workspace);
+}
+
+} // namespace sorting
+
+#endif // PARALLEL_SORT_H
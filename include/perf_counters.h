@@ -0,0 +1,59 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "sorting.h"
+
+// Hardware performance counters read through Linux perf_event_open.
+//
+// On construction one counter per event is opened for every thread of the
+// process, so the worker threads of the parallel sorts are counted too
+// (threads started later are not). Counts are user-space only, which works
+// with the default perf_event_paranoid setting, and are scaled for
+// multiplexing when the PMU has fewer counters than events. Events that
+// cannot be opened, as in most VMs and containers and on other operating
+// systems, are reported as missing instead of failing the benchmark.
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // True if at least one event could be opened
+    bool available() const;
+
+    // Why no event could be opened (empty when available)
+    const std::string& unavailableReason() const { return reason; }
+
+    // Count between start() and stop(); successive intervals accumulate
+    void start();
+    void stop();
+
+    // Drop the accumulated counts
+    void reset();
+
+    // Accumulated counts divided by divisor (e.g. the number of sorts)
+    PerfCounts read(double divisor) const;
+
+private:
+    enum Event {
+        CYCLES,
+        INSTRUCTIONS,
+        BRANCH_MISSES,
+        L1D_MISSES,
+        LLC_MISSES,
+        DTLB_MISSES,
+        EVENT_COUNT
+    };
+
+    // Open counters of each event, one per thread, and their scaled totals
+    std::vector<int> fds[EVENT_COUNT];
+    double totals[EVENT_COUNT] = {};
+    std::string reason;
+};
+
+#endif // PERF_COUNTERS_H
@@ -0,0 +1,189 @@
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+#include "sort_algorithms.h"
+#include "sort_workspace.h"
+
+// Radix sorts for integer keys. They sort by the key's bits instead of
+// comparisons, so they only apply to ranges of built-in integer types.
+namespace sorting {
+
+// Maps an integer to an unsigned key with the same ordering. Signed values
+// have their sign bit flipped, which moves negatives below non-negatives.
+template <typename T>
+struct RadixKey {
+    static_assert(std::is_integral<T>::value, "radix sort needs an integer key type");
+
+    using Unsigned = typename std::make_unsigned<T>::type;
+    static constexpr int BITS = static_cast<int>(sizeof(T) * CHAR_BIT);
+
+    static Unsigned get(T value) {
+        Unsigned key = static_cast<Unsigned>(value);
+        if (std::is_signed<T>::value) {
+            key ^= Unsigned(1) << (BITS - 1);
+        }
+        return key;
+    }
+};
+
+namespace detail {
+
+template <int DigitBits, typename T>
+inline std::size_t radixDigit(T value, int shift) {
+    return static_cast<std::size_t>((RadixKey<T>::get(value) >> shift) & ((1u << DigitBits) - 1));
+}
+
+// Buckets at or below this size are finished with insertion sort
+constexpr std::ptrdiff_t MSD_RADIX_CUTOFF = 32;
+
+// In-place American flag sort of [first, last) on the 8-bit digit at shift
+template <typename RandomIt>
+void americanFlagSort(RandomIt first, RandomIt last, int shift) {
+    using T = ValueType<RandomIt>;
+    constexpr std::size_t RADIX = 256;
+
+    while (true) {
+        std::ptrdiff_t n = last - first;
+        if (n <= MSD_RADIX_CUTOFF) {
+            insertionSort(first, last, std::less<T>());
+            return;
+        }
+
+        std::array<std::ptrdiff_t, RADIX> counts{};
+        for (RandomIt it = first; it != last; ++it) {
+            counts[radixDigit<8>(*it, shift)]++;
+        }
+
+        // Every key shares this digit: move on to the next one without a pass
+        if (std::find(counts.begin(), counts.end(), n) != counts.end()) {
+            if (shift == 0) return;
+            shift -= 8;
+            continue;
+        }
+
+        // next[b] is where the next element of bucket b goes, end[b] one past its slot
+        std::array<std::ptrdiff_t, RADIX> next;
+        std::array<std::ptrdiff_t, RADIX> end;
+        std::ptrdiff_t offset = 0;
+        for (std::size_t b = 0; b < RADIX; b++) {
+            next[b] = offset;
+            offset += counts[b];
+            end[b] = offset;
+        }
+
+        // Permute in place: follow each displaced element's cycle until an
+        // element that belongs in the current slot comes back
+        for (std::size_t b = 0; b < RADIX; b++) {
+            while (next[b] < end[b]) {
+                T value = first[next[b]];
+                std::size_t d = radixDigit<8>(value, shift);
+                while (d != b) {
+                    std::swap(value, first[next[d]++]);
+                    d = radixDigit<8>(value, shift);
+                }
+                first[next[b]++] = value;
+            }
+        }
+
+        if (shift == 0) return;
+
+        // Sort each bucket on the next digit
+        std::ptrdiff_t start = 0;
+        for (std::size_t b = 0; b < RADIX; b++) {
+            if (counts[b] > 1) {
+                americanFlagSort(first + start, first + start + counts[b], shift - 8);
+            }
+            start += counts[b];
+        }
+        return;
+    }
+}
+
+} // namespace detail
+
+// LSD radix sort with DigitBits-bit digits (8, 11 and 16 are the useful
+// choices). The histograms of every digit are built in one read of the input,
+// and passes whose digit is the same for all keys are skipped. Each remaining
+// pass scatters between the input and the workspace; stable. The range must
+// be contiguous in memory.
+template <int DigitBits, typename RandomIt>
+void lsdRadixSort(RandomIt first, RandomIt last, SortWorkspace<ValueType<RandomIt>>& workspace) {
+    using T = ValueType<RandomIt>;
+    static_assert(DigitBits > 0 && DigitBits <= 16, "digit width must be between 1 and 16 bits");
+
+    constexpr std::size_t RADIX = std::size_t(1) << DigitBits;
+    constexpr int PASSES = (RadixKey<T>::BITS + DigitBits - 1) / DigitBits;
+
+    std::ptrdiff_t n = last - first;
+    if (n < 2) return;
+
+    // One read of the input builds the histogram of every digit
+    std::vector<std::size_t> counts(PASSES * RADIX, 0);
+    for (RandomIt it = first; it != last; ++it) {
+        auto key = RadixKey<T>::get(*it);
+        for (int pass = 0; pass < PASSES; pass++) {
+            counts[pass * RADIX + ((key >> (pass * DigitBits)) & (RADIX - 1))]++;
+        }
+    }
+
+    workspace.reserve(static_cast<std::size_t>(n));
+    T* data = &*first;
+    T* buffer = workspace.data();
+    T* src = data;
+    T* dst = buffer;
+
+    for (int pass = 0; pass < PASSES; pass++) {
+        std::size_t* count = &counts[pass * RADIX];
+        int shift = pass * DigitBits;
+
+        // A digit shared by every key would not move anything
+        if (count[detail::radixDigit<DigitBits>(src[0], shift)] == static_cast<std::size_t>(n)) {
+            continue;
+        }
+
+        // Exclusive prefix sum turns counts into bucket offsets
+        std::size_t offset = 0;
+        for (std::size_t b = 0; b < RADIX; b++) {
+            std::size_t c = count[b];
+            count[b] = offset;
+            offset += c;
+        }
+
+        for (std::ptrdiff_t i = 0; i < n; i++) {
+            dst[count[detail::radixDigit<DigitBits>(src[i], shift)]++] = src[i];
+        }
+
+        std::swap(src, dst);
+    }
+
+    // An odd number of passes leaves the result in the workspace
+    if (src != data) {
+        std::copy(src, src + n, data);
+    }
+}
+
+template <int DigitBits, typename RandomIt>
+void lsdRadixSort(RandomIt first, RandomIt last) {
+    SortWorkspace<ValueType<RandomIt>> workspace;
+    lsdRadixSort<DigitBits>(first, last, workspace);
+}
+
+// MSD radix sort: in-place American flag partitioning on 8-bit digits from
+// the most significant end, with insertion sort for small buckets. Not stable.
+template <typename RandomIt>
+void msdRadixSort(RandomIt first, RandomIt last) {
+    using T = ValueType<RandomIt>;
+    if (last - first < 2) return;
+
+    detail::americanFlagSort(first, last, RadixKey<T>::BITS - 8);
+}
+
+} // namespace sorting
+
+#endif // RADIX_SORT_H
@@ -0,0 +1,81 @@
+#ifndef RANDOM_STREAM_H
+#define RANDOM_STREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Deterministic random numbers for the data set generators.
+//
+// Xoshiro256 is xoshiro256** (Blackman and Vigna), seeded through
+// splitmix64. Its jump() advances the stream by 2^128 values, which splits
+// one seed into non-overlapping streams: fillRandomBlocks gives block b of
+// the output the stream after b jumps, so a data set is the same bytes
+// whether one thread or many fill it. Bounded values and doubles are derived
+// here rather than with the <random> distributions, whose output differs
+// between standard libraries.
+class Xoshiro256 {
+public:
+    using result_type = std::uint64_t;
+
+    explicit Xoshiro256(std::uint64_t seed);
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~result_type(0); }
+
+    result_type operator()() {
+        const std::uint64_t result = rotl(state[1] * 5, 7) * 9;
+        const std::uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // Uniform value in [0, range) for 0 < range <= 2^32, without bias
+    // (Lemire's multiply-shift with rejection)
+    std::uint64_t below(std::uint64_t range) {
+        std::uint64_t product = ((*this)() >> 32) * range;
+        if (static_cast<std::uint32_t>(product) < range) {
+            const std::uint32_t threshold = static_cast<std::uint32_t>((std::uint64_t(1) << 32) % range);
+            while (static_cast<std::uint32_t>(product) < threshold) {
+                product = ((*this)() >> 32) * range;
+            }
+        }
+        return product >> 32;
+    }
+
+    // Uniform double in [0, 1) with 53 random bits
+    double uniform() {
+        return static_cast<double>((*this)() >> 11) * 0x1.0p-53;
+    }
+
+    // Advance the stream by 2^128 values
+    void jump();
+
+private:
+    std::uint64_t state[4];
+
+    static std::uint64_t rotl(std::uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+};
+
+// Elements per block of fillRandomBlocks; part of the output format, since
+// changing it changes which stream fills which element
+constexpr std::size_t RANDOM_BLOCK_SIZE = std::size_t(1) << 16;
+
+// Fill data block by block, calling fill(generator, first, last) for each
+// block with the generator positioned at that block's stream. Large arrays
+// are filled on a shared pool of hardware_concurrency threads.
+void fillRandomBlocks(
+    std::vector<int>& data,
+    std::uint64_t seed,
+    const std::function<void(Xoshiro256& generator, int* first, int* last)>& fill
+);
+
+#endif // RANDOM_STREAM_H
@@ -0,0 +1,23 @@
+#ifndef RUN_METADATA_H
+#define RUN_METADATA_H
+
+#include <string>
+
+// Where and how a benchmark run was made, recorded with its results so rows
+// from different hosts and builds can be told apart. Fields that cannot be
+// determined are "unknown".
+struct RunMetadata {
+    std::string timestamp;   // start of the run, UTC, ISO 8601
+    std::string host;
+    std::string cpuModel;
+    unsigned logicalCpus = 0;
+    std::string isa;         // SIMD level the sorts dispatch to (simd_sort.h)
+    std::string compiler;
+    std::string buildFlags;  // CXXFLAGS, passed in by the Makefile
+    std::string gitHash;     // git describe of the source tree at build time
+};
+
+// Collect the metadata of the current process and build
+RunMetadata collectRunMetadata();
+
+#endif // RUN_METADATA_H
@@ -0,0 +1,76 @@
+#ifndef SIMD_SORT_H
+#define SIMD_SORT_H
+
+#include <cstddef>
+#include <cstdint>
+
+// SIMD kernels for int keys, selected at runtime from what the CPU supports.
+// Everything here also compiles on non-x86 targets, where the kernels report
+// that they are unavailable and callers use their scalar code.
+namespace sorting {
+namespace simd {
+
+enum class IsaLevel {
+    SCALAR,
+    SSE41,
+    AVX2
+};
+
+// Best instruction set available on this CPU (detected once)
+IsaLevel detectIsa();
+
+// Keep the kernels below level, so the fallback paths can be tested and
+// benchmarked on a CPU that has the wider ones. Applies to later calls.
+void limitIsa(IsaLevel level);
+
+// Instruction set the kernels use: detectIsa(), capped by limitIsa
+IsaLevel activeIsa();
+
+// Name of an instruction set level, e.g. for reports
+const char* isaName(IsaLevel level);
+
+// Largest range sortNetwork accepts
+constexpr std::ptrdiff_t MAX_NETWORK_SIZE = 64;
+
+// Sort data[0, n) ascending with a bitonic sorting network of 8, 16, 32 or 64
+// lanes, padding the unused lanes with INT_MAX. Returns false, leaving data
+// untouched, if n > MAX_NETWORK_SIZE or the CPU has neither AVX2 nor SSE4.1.
+bool sortNetwork(int* data, std::ptrdiff_t n);
+
+// Merge the sorted ranges a[0, na) and b[0, nb) into out[0, na + nb) with an
+// AVX2 bitonic merge network, 16 elements a step (8 for runs under 16), and
+// scalar code for the last partial blocks. out may overlap the back of b, as
+// in an in-place merge whose first run was moved to a buffer, as long as
+// out + na <= b. Returns false, writing nothing, if either run is shorter
+// than 8 or the CPU lacks AVX2.
+bool mergeInts(const int* a, std::ptrdiff_t na, const int* b, std::ptrdiff_t nb, int* out);
+
+// Same merge written back to front, so out may overlap the front of a
+// instead (out == a when the second run was moved to a buffer)
+bool mergeIntsBackward(const int* a, std::ptrdiff_t na, const int* b, std::ptrdiff_t nb, int* out);
+
+// Key/index pairs packed so that signed 64-bit order is key order, ties
+// broken by index. Merging packed pairs is therefore stable whenever every
+// index in the first run is below those in the second, which holds for the
+// halves of a merge sort that tagged elements with their positions.
+inline std::int64_t packKeyIndex(int key, std::uint32_t index) {
+    return static_cast<std::int64_t>(key) * (std::int64_t(1) << 32) + index;
+}
+
+inline int keyOf(std::int64_t packed) {
+    return static_cast<int>(packed >> 32);
+}
+
+inline std::uint32_t indexOf(std::int64_t packed) {
+    return static_cast<std::uint32_t>(packed);
+}
+
+// mergeInts for packed key/index pairs, 8 pairs a step (4 for runs under 8).
+// Returns false if either run is shorter than 4 or the CPU lacks AVX2.
+bool mergeKeyIndex(const std::int64_t* a, std::ptrdiff_t na, const std::int64_t* b, std::ptrdiff_t nb,
+                   std::int64_t* out);
+
+} // namespace simd
+} // namespace sorting
+
+#endif // SIMD_SORT_H
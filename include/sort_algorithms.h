@@ -0,0 +1,1568 @@
+#ifndef SORT_ALGORITHMS_H
+#define SORT_ALGORITHMS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "loser_tree.h"
+#include "simd_sort.h"
+#include "sort_workspace.h"
+
+// Templated front end for every algorithm in sorting.h.
+//
+// Each function takes a random-access range and a comparator, so the element
+// type and comparison are known at compile time and inline into the loops.
+// The SortingAlgorithm classes are thin adapters that forward
+// std::vector<int> to these with std::less<int>.
+namespace sorting {
+
+template <typename RandomIt>
+using ValueType = typename std::iterator_traits<RandomIt>::value_type;
+
+template <typename RandomIt>
+using DiffType = typename std::iterator_traits<RandomIt>::difference_type;
+
+// Insertion sort
+template <typename RandomIt, typename Compare = std::less<>>
+void insertionSort(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    if (last - first < 2) return;
+
+    for (RandomIt i = first + 1; i != last; ++i) {
+        ValueType<RandomIt> key = std::move(*i);
+        RandomIt j = i;
+
+        // Move elements greater than key one position ahead
+        while (j != first && comp(key, *(j - 1))) {
+            *j = std::move(*(j - 1));
+            --j;
+        }
+        *j = std::move(key);
+    }
+}
+
+namespace detail {
+
+// Ranges of int in contiguous memory ordered by std::less can be sorted and
+// merged by the SIMD networks in simd_sort.h
+template <typename RandomIt, typename Compare>
+struct UsesIntNetwork : std::integral_constant<bool,
+    std::is_same<ValueType<RandomIt>, int>::value &&
+    (std::is_same<Compare, std::less<int>>::value || std::is_same<Compare, std::less<>>::value) &&
+    (std::is_pointer<RandomIt>::value || std::is_same<RandomIt, std::vector<int>::iterator>::value)> {};
+
+// Base case of the divide-and-conquer sorts: a SIMD sorting network when the
+// range qualifies and the CPU supports one, insertion sort otherwise
+template <typename RandomIt, typename Compare>
+void smallSort(RandomIt first, RandomIt last, Compare comp) {
+    if (last - first < 2) return;
+
+    if constexpr (UsesIntNetwork<RandomIt, Compare>::value) {
+        if (simd::sortNetwork(&*first, last - first)) return;
+    }
+    insertionSort(first, last, comp);
+}
+
+// Size at or below which a sort hands ranges to smallSort. The sorting
+// networks stay cheaper than partitioning or merging up to their full width;
+// insertion sort only on short ranges.
+template <typename RandomIt, typename Compare>
+std::ptrdiff_t smallSortCutoff(std::ptrdiff_t scalarCutoff) {
+    if constexpr (UsesIntNetwork<RandomIt, Compare>::value) {
+        if (simd::activeIsa() != simd::IsaLevel::SCALAR) return simd::MAX_NETWORK_SIZE;
+    }
+    return scalarCutoff;
+}
+
+} // namespace detail
+
+// Bubble sort
+template <typename RandomIt, typename Compare = std::less<>>
+void bubbleSort(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    DiffType<RandomIt> n = last - first;
+
+    for (DiffType<RandomIt> i = 0; i < n - 1; i++) {
+        bool swapped = false;
+
+        // Last i elements are already in place
+        for (DiffType<RandomIt> j = 0; j < n - i - 1; j++) {
+            if (comp(first[j + 1], first[j])) {
+                std::iter_swap(first + j, first + j + 1);
+                swapped = true;
+            }
+        }
+
+        // If no swapping occurred in this pass, range is sorted
+        if (!swapped)
+            break;
+    }
+}
+
+// Cocktail shaker sort
+template <typename RandomIt, typename Compare = std::less<>>
+void cocktailSort(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    DiffType<RandomIt> n = last - first;
+    if (n <= 1) return;
+
+    bool swapped = true;
+    DiffType<RandomIt> start = 0;
+    DiffType<RandomIt> end = n - 1;
+
+    while (swapped) {
+        swapped = false;
+
+        // Forward pass (like bubble sort)
+        for (DiffType<RandomIt> i = start; i < end; i++) {
+            if (comp(first[i + 1], first[i])) {
+                std::iter_swap(first + i, first + i + 1);
+                swapped = true;
+            }
+        }
+
+        if (!swapped)
+            break;
+
+        swapped = false;
+
+        // The largest element is now at the end
+        end--;
+
+        // Backward pass
+        for (DiffType<RandomIt> i = end - 1; i >= start; i--) {
+            if (comp(first[i + 1], first[i])) {
+                std::iter_swap(first + i, first + i + 1);
+                swapped = true;
+            }
+        }
+
+        // The smallest element is now at the start
+        start++;
+    }
+}
+
+// Selection sort
+template <typename RandomIt, typename Compare = std::less<>>
+void selectionSort(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    for (RandomIt i = first; i != last; ++i) {
+        // Find the minimum element in the unsorted part
+        RandomIt minIt = i;
+        for (RandomIt j = i + 1; j != last; ++j) {
+            if (comp(*j, *minIt)) {
+                minIt = j;
+            }
+        }
+
+        if (minIt != i) {
+            std::iter_swap(minIt, i);
+        }
+    }
+}
+
+// Comb sort
+template <typename RandomIt, typename Compare = std::less<>>
+void combSort(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    DiffType<RandomIt> n = last - first;
+    if (n <= 1) return;
+
+    DiffType<RandomIt> gap = n;
+    const double shrink = 1.3; // common shrink factor
+    bool swapped = true;
+
+    // Keep running while gap is more than 1 and last iteration caused a swap
+    while (gap > 1 || swapped) {
+        gap = static_cast<DiffType<RandomIt>>(gap / shrink);
+        if (gap < 1)
+            gap = 1;
+
+        swapped = false;
+
+        // Compare elements with gap
+        for (DiffType<RandomIt> i = 0; i + gap < n; i++) {
+            if (comp(first[i + gap], first[i])) {
+                std::iter_swap(first + i, first + i + gap);
+                swapped = true;
+            }
+        }
+    }
+}
+
+// Merge sort
+namespace detail {
+
+// Ranges at or below this size are finished with insertion sort
+// (see smallSortCutoff for when a sorting network takes over)
+constexpr std::ptrdiff_t MERGE_SORT_CUTOFF = 16;
+
+// Stable merge of the sorted ranges [first1, last1) and [first2, last2) into out
+template <typename InIt, typename OutIt, typename Compare>
+OutIt mergeInto(InIt first1, InIt last1, InIt first2, InIt last2, OutIt out, Compare comp) {
+    // Equal ints are interchangeable, so the network needs no tie rule
+    if constexpr (UsesIntNetwork<InIt, Compare>::value && UsesIntNetwork<OutIt, Compare>::value) {
+        std::ptrdiff_t n1 = last1 - first1;
+        std::ptrdiff_t n2 = last2 - first2;
+        if (n1 > 0 && n2 > 0 && simd::mergeInts(&*first1, n1, &*first2, n2, &*out)) {
+            return out + (n1 + n2);
+        }
+    }
+
+    // Take from the left run on ties to stay stable
+    while (first1 != last1 && first2 != last2) {
+        if (!comp(*first2, *first1)) {
+            *out++ = std::move(*first1++);
+        } else {
+            *out++ = std::move(*first2++);
+        }
+    }
+
+    out = std::move(first1, last1, out);
+    return std::move(first2, last2, out);
+}
+
+// Sort [dst, dst + n) given that [src, src + n) holds the same elements.
+// The halves are sorted into src, using dst as their scratch space, and then
+// merged back into dst, so the buffers swap roles at every level and no
+// copy-back pass is needed.
+template <typename DstIt, typename SrcIt, typename Compare>
+void mergeSortPingPong(DstIt dst, SrcIt src, std::ptrdiff_t n, Compare comp) {
+    if (n <= smallSortCutoff<DstIt, Compare>(MERGE_SORT_CUTOFF)) {
+        smallSort(dst, dst + n, comp);
+        return;
+    }
+
+    std::ptrdiff_t mid = n / 2;
+
+    mergeSortPingPong(src, dst, mid, comp);
+    mergeSortPingPong(src + mid, dst + mid, n - mid, comp);
+
+    // Already in order: just move the elements across
+    if (!comp(src[mid], src[mid - 1])) {
+        std::move(src, src + n, dst);
+        return;
+    }
+
+    mergeInto(src, src + mid, src + mid, src + n, dst, comp);
+}
+
+} // namespace detail
+
+// Merge sort using caller-supplied scratch memory. The workspace is grown to n
+// elements if needed; reusing it across calls avoids all allocation.
+template <typename RandomIt, typename Compare = std::less<>>
+void mergeSort(RandomIt first, RandomIt last, SortWorkspace<ValueType<RandomIt>>& workspace,
+               Compare comp = Compare()) {
+    std::ptrdiff_t n = last - first;
+    if (n < 2) return;
+
+    workspace.reserve(static_cast<std::size_t>(n));
+    ValueType<RandomIt>* buffer = workspace.data();
+
+    // One copy up front; after that the two buffers alternate as source and destination
+    std::copy(first, last, buffer);
+    detail::mergeSortPingPong(first, buffer, n, comp);
+}
+
+template <typename RandomIt, typename Compare = std::less<>>
+void mergeSort(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    SortWorkspace<ValueType<RandomIt>> workspace;
+    mergeSort(first, last, workspace, comp);
+}
+
+// Heap sort
+namespace detail {
+
+
+// Heaps at or below this many elements stay in cache, so their layout is not
+// worth aligning nor their children prefetching
+constexpr std::ptrdiff_t HEAP_ALIGN_THRESHOLD = 4096;
+
+template <typename RandomIt>
+struct IsContiguous : std::integral_constant<bool,
+    std::is_pointer<RandomIt>::value ||
+    (std::is_same<RandomIt, typename std::vector<ValueType<RandomIt>>::iterator>::value &&
+     !std::is_same<ValueType<RandomIt>, bool>::value)> {};
+
+inline void prefetchForRead(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address, 0, 3);
+#else
+    (void)address;
+#endif
+}
+
+// Elements to keep in front of the heap so that every group of siblings
+// starts on a multiple of its own size and never straddles a cache line.
+// Zero when the range is not contiguous or a group does not divide a line.
+template <std::ptrdiff_t Arity, typename RandomIt>
+std::ptrdiff_t heapAlignmentOffset(RandomIt first, std::ptrdiff_t n) {
+    if constexpr (IsContiguous<RandomIt>::value) {
+        constexpr std::size_t elementBytes = sizeof(ValueType<RandomIt>);
+        constexpr std::size_t groupBytes = Arity * elementBytes;
+        if constexpr (groupBytes <= 64 && (groupBytes & (groupBytes - 1)) == 0) {
+            auto address = reinterpret_cast<std::uintptr_t>(&*first);
+            if (n <= HEAP_ALIGN_THRESHOLD || address % elementBytes != 0) return 0;
+
+            // The children of node i sit at offset + Arity * i + 1, so the
+            // heap starts one element before a group boundary
+            auto slot = static_cast<std::ptrdiff_t>(address % groupBytes / elementBytes);
+            return (2 * Arity - slot - 1) % Arity;
+        }
+    }
+    (void)first;
+    (void)n;
+    return 0;
+}
+
+// Move the k smallest elements of the range, sorted, to its front. One pass
+// with at most k moves per element, so linear time and no extra space.
+template <typename RandomIt, typename Compare>
+void gatherSmallest(RandomIt first, RandomIt last, DiffType<RandomIt> k, Compare comp) {
+    insertionSort(first, first + k, comp);
+    RandomIt back = first + (k - 1);
+    for (RandomIt i = first + k; i != last; ++i) {
+        if (!comp(*i, *back)) continue;
+
+        ValueType<RandomIt> value = std::move(*i);
+        *i = std::move(*back);
+        RandomIt j = back;
+        while (j != first && comp(value, *(j - 1))) {
+            *j = std::move(*(j - 1));
+            --j;
+        }
+        *j = std::move(value);
+    }
+}
+
+// Index of the largest of the Count elements from start, found by a
+// tournament so that its comparisons do not wait on each other. Which child
+// is largest is a coin toss the branch predictor cannot learn, so the winner
+// is computed from the comparison rather than chosen with ?:, which compilers
+// turn back into a branch.
+template <std::ptrdiff_t Count, typename RandomIt, typename Compare>
+DiffType<RandomIt> largestChild(RandomIt first, DiffType<RandomIt> start, Compare comp) {
+    if constexpr (Count == 1) {
+        return start;
+    } else {
+        DiffType<RandomIt> left = largestChild<Count / 2>(first, start, comp);
+        DiffType<RandomIt> right = largestChild<Count - Count / 2>(first, start + Count / 2, comp);
+        return left + (right - left) * DiffType<RandomIt>(comp(first[left], first[right]));
+    }
+}
+
+// Sift value down a d-ary max-heap of size n from the hole at `hole`, each
+// level pulling up the largest child until none is larger than value. The
+// largest child is found without branching; the test against value is the
+// one branch, and it goes the same way for most of the descent. With Prefetch
+// set, the grandchildren are prefetched one level ahead; heaps that fit in
+// cache would only pay for it.
+template <std::ptrdiff_t Arity, bool Prefetch, typename RandomIt, typename Compare>
+void siftDown(RandomIt first, DiffType<RandomIt> n, DiffType<RandomIt> hole,
+              ValueType<RandomIt> value, Compare comp) {
+    using Diff = DiffType<RandomIt>;
+    constexpr Diff lineElements = std::max<Diff>(1, 64 / sizeof(ValueType<RandomIt>));
+    constexpr Diff grandchildLines = (Arity * Arity + lineElements - 1) / lineElements;
+
+    for (Diff child = Arity * hole + 1; child < n; child = Arity * hole + 1) {
+        if constexpr (Prefetch) {
+            Diff grandchild = Arity * child + 1;
+            for (Diff line = 0; line < grandchildLines; line++) {
+                Diff g = grandchild + line * lineElements;
+                if (g < n) prefetchForRead(&*(first + g));
+            }
+        }
+
+        Diff largest = child;
+        if (child + Arity <= n) {
+            largest = largestChild<Arity>(first, child, comp);
+        } else {
+            for (Diff c = child + 1; c < n; c++) {
+                largest += (c - largest) * Diff(comp(first[largest], first[c]));
+            }
+        }
+        if (!comp(value, first[largest])) break;
+        first[hole] = std::move(first[largest]);
+        hole = largest;
+    }
+    first[hole] = std::move(value);
+}
+
+// Floyd's bottom-up sift-down on a d-ary max-heap of size n: move the hole at
+// `hole` down to a leaf, each level pulling up the largest child, then sift
+// value up from there. Values taken from the bottom of the heap belong near
+// the bottom, so the walk back up is short, and the descent needs no
+// comparison against value. Prefetch as for siftDown.
+template <std::ptrdiff_t Arity, bool Prefetch, typename RandomIt, typename Compare>
+void siftDownBottomUp(RandomIt first, DiffType<RandomIt> n, DiffType<RandomIt> hole,
+                      ValueType<RandomIt> value, Compare comp) {
+    using Diff = DiffType<RandomIt>;
+    constexpr Diff lineElements = std::max<Diff>(1, 64 / sizeof(ValueType<RandomIt>));
+    constexpr Diff grandchildLines = (Arity * Arity + lineElements - 1) / lineElements;
+    const Diff top = hole;
+
+    for (Diff child = Arity * hole + 1; child < n; child = Arity * hole + 1) {
+        if constexpr (Prefetch) {
+            Diff grandchild = Arity * child + 1;
+            for (Diff line = 0; line < grandchildLines; line++) {
+                Diff g = grandchild + line * lineElements;
+                if (g < n) prefetchForRead(&*(first + g));
+            }
+        }
+
+        Diff largest = child;
+        if (child + Arity <= n) {
+            largest = largestChild<Arity>(first, child, comp);
+        } else {
+            for (Diff c = child + 1; c < n; c++) {
+                largest += (c - largest) * Diff(comp(first[largest], first[c]));
+            }
+        }
+        first[hole] = std::move(first[largest]);
+        hole = largest;
+    }
+
+    while (hole > top) {
+        Diff parent = (hole - 1) / Arity;
+        if (!comp(first[parent], value)) break;
+        first[hole] = std::move(first[parent]);
+        hole = parent;
+    }
+    first[hole] = std::move(value);
+}
+
+template <std::ptrdiff_t Arity, bool BottomUp, bool Prefetch, typename RandomIt, typename Compare>
+void siftHole(RandomIt first, DiffType<RandomIt> n, DiffType<RandomIt> hole,
+              ValueType<RandomIt> value, Compare comp) {
+    if constexpr (BottomUp) {
+        siftDownBottomUp<Arity, Prefetch>(first, n, hole, std::move(value), comp);
+    } else {
+        siftDown<Arity, Prefetch>(first, n, hole, std::move(value), comp);
+    }
+}
+
+// Heap sort on a d-ary heap, sifting with siftDownBottomUp or siftDown.
+// Contiguous ranges start the heap a few elements in, so that sibling groups
+// are cache-line aligned; those elements are the smallest of the range and
+// are set aside sorted first.
+template <std::ptrdiff_t Arity, bool BottomUp, typename RandomIt, typename Compare>
+void heapSortLoop(RandomIt first, RandomIt last, Compare comp) {
+    static_assert(Arity >= 2, "a heap needs at least two children per node");
+    using Diff = DiffType<RandomIt>;
+    Diff n = last - first;
+    if (n < 2) return;
+
+    Diff offset = heapAlignmentOffset<Arity>(first, n);
+    if (offset > 0) {
+        gatherSmallest(first, last, offset, comp);
+        first += offset;
+        n -= offset;
+    }
+
+    // Build the heap from the last parent up
+    for (Diff i = (n - 2) / Arity; i >= 0; i--) {
+        ValueType<RandomIt> value = std::move(first[i]);
+        if (n > HEAP_ALIGN_THRESHOLD) {
+            siftHole<Arity, BottomUp, true>(first, n, i, std::move(value), comp);
+        } else {
+            siftHole<Arity, BottomUp, false>(first, n, i, std::move(value), comp);
+        }
+    }
+
+    // Move the maximum behind the heap and refill the root from its end,
+    // prefetching until the heap has shrunk into cache
+    Diff end = n - 1;
+    for (; end > HEAP_ALIGN_THRESHOLD; end--) {
+        ValueType<RandomIt> value = std::move(first[end]);
+        first[end] = std::move(first[0]);
+        siftHole<Arity, BottomUp, true>(first, end, Diff(0), std::move(value), comp);
+    }
+    for (; end > 0; end--) {
+        ValueType<RandomIt> value = std::move(first[end]);
+        first[end] = std::move(first[0]);
+        siftHole<Arity, BottomUp, false>(first, end, Diff(0), std::move(value), comp);
+    }
+}
+
+} // namespace detail
+
+// Heap sort on a 4- or 8-ary heap with Floyd's bottom-up sift-down: a wide
+// heap is half or a third as deep as a binary one, and each group of
+// children is one aligned cache line. O(1) extra space and O(n log n) in the
+// worst case.
+template <std::ptrdiff_t Arity, typename RandomIt, typename Compare = std::less<>>
+void dAryHeapSort(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    detail::heapSortLoop<Arity, true>(first, last, comp);
+}
+
+// Heap sort on a binary heap, sifting top-down. On ints it is the fastest of
+// the heap sorts while the heap fits in cache; beyond that dAryHeapSort<4>
+// is, by up to 1.7x on random keys. On the ranges the quick sorts hand over
+// when they fall back to heap sort, the two run level.
+template <typename RandomIt, typename Compare = std::less<>>
+void heapSort(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    detail::heapSortLoop<2, false>(first, last, comp);
+}
+
+// Quick sort (introsort)
+namespace detail {
+
+// Partitions at or below this size are finished with insertion sort
+// (see smallSortCutoff for when a sorting network takes over)
+constexpr std::ptrdiff_t QUICK_SORT_CUTOFF = 16;
+
+// Partitions above this size pick their pivot with Tukey's ninther
+constexpr std::ptrdiff_t NINTHER_THRESHOLD = 128;
+
+template <typename RandomIt, typename Compare>
+RandomIt medianOf3(RandomIt a, RandomIt b, RandomIt c, Compare comp) {
+    if (comp(*a, *b)) {
+        if (comp(*b, *c)) return b;
+        return comp(*a, *c) ? c : a;
+    }
+    if (comp(*a, *c)) return a;
+    return comp(*b, *c) ? c : b;
+}
+
+// Move the pivot (median of 3, or ninther for large ranges) to *first
+template <typename RandomIt, typename Compare>
+void choosePivot(RandomIt first, RandomIt last, Compare comp) {
+    std::ptrdiff_t n = last - first;
+    RandomIt mid = first + n / 2;
+    RandomIt pivot;
+
+    if (n > NINTHER_THRESHOLD) {
+        std::ptrdiff_t step = n / 8;
+        RandomIt m1 = medianOf3(first + 1, first + 1 + step, first + 1 + 2 * step, comp);
+        RandomIt m2 = medianOf3(mid - step, mid, mid + step, comp);
+        RandomIt m3 = medianOf3(last - 1 - 2 * step, last - 1 - step, last - 1, comp);
+        pivot = medianOf3(m1, m2, m3, comp);
+    } else {
+        pivot = medianOf3(first + 1, mid, last - 1, comp);
+    }
+
+    std::iter_swap(first, pivot);
+}
+
+// Hoare partition of [first + 1, last) around the pivot at *first.
+// Returns cut such that [first, cut) <= pivot <= [cut, last). The pivot was
+// the median of a sample taken from this range, so both scans are guaranteed
+// to stop without bounds checks.
+template <typename RandomIt, typename Compare>
+RandomIt hoarePartition(RandomIt first, RandomIt last, Compare comp) {
+    RandomIt i = first + 1;
+    RandomIt j = last;
+
+    while (true) {
+        while (comp(*i, *first)) ++i;
+        --j;
+        while (comp(*first, *j)) --j;
+        if (!(i < j)) return i;
+        std::iter_swap(i, j);
+        ++i;
+    }
+}
+
+// Depth limit after which introsort gives up on quicksort: 2 * floor(log2(n))
+inline int introsortDepthLimit(std::ptrdiff_t n) {
+    int depth = 0;
+    while (n > 1) {
+        n >>= 1;
+        depth++;
+    }
+    return 2 * depth;
+}
+
+template <typename RandomIt, typename Compare>
+void introsortLoop(RandomIt first, RandomIt last, int depthLimit, Compare comp) {
+    const std::ptrdiff_t cutoff = smallSortCutoff<RandomIt, Compare>(QUICK_SORT_CUTOFF);
+
+    while (last - first > cutoff) {
+        // Too many unbalanced partitions: heap sort bounds the worst case
+        if (depthLimit == 0) {
+            heapSort(first, last, comp);
+            return;
+        }
+        depthLimit--;
+
+        choosePivot(first, last, comp);
+        RandomIt cut = hoarePartition(first, last, comp);
+
+        // Recurse into the smaller side and loop on the larger one,
+        // so the stack never grows beyond O(log n) frames
+        if (cut - first < last - cut) {
+            introsortLoop(first, cut, depthLimit, comp);
+            first = cut;
+        } else {
+            introsortLoop(cut, last, depthLimit, comp);
+            last = cut;
+        }
+    }
+
+    smallSort(first, last, comp);
+}
+
+} // namespace detail
+
+// Introsort: quicksort with ninther pivots that falls back to heap sort past
+// 2 * log2(n) levels and finishes small partitions with insertion sort.
+// Worst case O(n log n), O(log n) stack.
+template <typename RandomIt, typename Compare = std::less<>>
+void quickSort(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    if (last - first < 2) return;
+    detail::introsortLoop(first, last, detail::introsortDepthLimit(last - first), comp);
+}
+
+// Pattern-defeating quicksort
+namespace detail {
+
+// Partitions smaller than this are finished with insertion sort
+constexpr std::ptrdiff_t PDQ_INSERTION_SORT_THRESHOLD = 24;
+
+// Maximum number of elements partialInsertionSort may move before giving up
+constexpr std::ptrdiff_t PDQ_PARTIAL_INSERTION_SORT_LIMIT = 8;
+
+// Elements classified per block by the branchless partition; offsets fit in a byte
+constexpr std::ptrdiff_t PDQ_BLOCK_SIZE = 64;
+
+// The branchless partition pays off when comparisons are cheap and their
+// outcome is unpredictable, i.e. the default comparators on arithmetic keys
+template <typename Compare>
+struct IsDefaultCompare : std::false_type {};
+template <typename T>
+struct IsDefaultCompare<std::less<T>> : std::true_type {};
+template <typename T>
+struct IsDefaultCompare<std::greater<T>> : std::true_type {};
+
+// Insertion sort that relies on *(first - 1) being <= every element in
+// [first, last), so the inner loop needs no bounds check
+template <typename RandomIt, typename Compare>
+void unguardedInsertionSort(RandomIt first, RandomIt last, Compare comp) {
+    if (first == last) return;
+
+    for (RandomIt cur = first + 1; cur != last; ++cur) {
+        RandomIt sift = cur;
+        RandomIt sift1 = cur - 1;
+
+        if (comp(*sift, *sift1)) {
+            ValueType<RandomIt> tmp = std::move(*sift);
+            do {
+                *sift-- = std::move(*sift1);
+            } while (comp(tmp, *--sift1));
+            *sift = std::move(tmp);
+        }
+    }
+}
+
+// Insertion sort that gives up (returning false) once it has moved more than
+// PDQ_PARTIAL_INSERTION_SORT_LIMIT elements. Cheap on nearly sorted input.
+template <typename RandomIt, typename Compare>
+bool partialInsertionSort(RandomIt first, RandomIt last, Compare comp) {
+    if (first == last) return true;
+
+    std::ptrdiff_t limit = 0;
+    for (RandomIt cur = first + 1; cur != last; ++cur) {
+        RandomIt sift = cur;
+        RandomIt sift1 = cur - 1;
+
+        if (comp(*sift, *sift1)) {
+            ValueType<RandomIt> tmp = std::move(*sift);
+            do {
+                *sift-- = std::move(*sift1);
+            } while (sift != first && comp(tmp, *--sift1));
+            *sift = std::move(tmp);
+            limit += cur - sift;
+        }
+
+        if (limit > PDQ_PARTIAL_INSERTION_SORT_LIMIT) return false;
+    }
+    return true;
+}
+
+template <typename RandomIt, typename Compare>
+void sort2(RandomIt a, RandomIt b, Compare comp) {
+    if (comp(*b, *a)) std::iter_swap(a, b);
+}
+
+template <typename RandomIt, typename Compare>
+void sort3(RandomIt a, RandomIt b, RandomIt c, Compare comp) {
+    sort2(a, b, comp);
+    sort2(b, c, comp);
+    sort2(a, b, comp);
+}
+
+// Swap the elements first[offsetsL[i]] and last[-offsetsR[i]] for i < num.
+// When the counts differ the swaps are done as one cyclic permutation,
+// which needs fewer moves than pairwise swaps.
+template <typename RandomIt>
+void swapOffsets(RandomIt first, RandomIt last, const unsigned char* offsetsL,
+                 const unsigned char* offsetsR, std::ptrdiff_t num, bool useSwaps) {
+    if (useSwaps) {
+        for (std::ptrdiff_t i = 0; i < num; i++) {
+            std::iter_swap(first + offsetsL[i], last - offsetsR[i]);
+        }
+    } else if (num > 0) {
+        RandomIt l = first + offsetsL[0];
+        RandomIt r = last - offsetsR[0];
+        ValueType<RandomIt> tmp = std::move(*l);
+        *l = std::move(*r);
+        for (std::ptrdiff_t i = 1; i < num; i++) {
+            l = first + offsetsL[i];
+            *r = std::move(*l);
+            r = last - offsetsR[i];
+            *l = std::move(*r);
+        }
+        *r = std::move(tmp);
+    }
+}
+
+// Partition [first, last) around the pivot *first; elements equal to the pivot
+// go right. Returns the pivot's final position and whether the range was
+// already partitioned (no swaps needed).
+//
+// BlockQuicksort scheme: a block of up to PDQ_BLOCK_SIZE elements on each side
+// is classified with no data-dependent branch, by writing every offset and
+// advancing the count by the comparison result. Misplaced elements are then
+// swapped in bulk.
+template <typename RandomIt, typename Compare>
+std::pair<RandomIt, bool> partitionRightBranchless(RandomIt begin, RandomIt end, Compare comp) {
+    ValueType<RandomIt> pivot = std::move(*begin);
+    RandomIt first = begin;
+    RandomIt last = end;
+
+    // Find the first element >= pivot (the median-of-3 guarantees one exists)
+    while (comp(*++first, pivot));
+
+    // Find the last element < pivot; guard only if nothing was skipped above
+    if (first - 1 == begin) {
+        while (first < last && !comp(*--last, pivot));
+    } else {
+        while (!comp(*--last, pivot));
+    }
+
+    bool alreadyPartitioned = first >= last;
+    if (!alreadyPartitioned) {
+        std::iter_swap(first, last);
+        ++first;
+
+        alignas(64) unsigned char offsetsL[PDQ_BLOCK_SIZE];
+        alignas(64) unsigned char offsetsR[PDQ_BLOCK_SIZE];
+
+        RandomIt offsetsLBase = first;
+        RandomIt offsetsRBase = last;
+        std::ptrdiff_t numL = 0, numR = 0, startL = 0, startR = 0;
+
+        while (first < last) {
+            // Refill whichever side ran out; split the remainder when both did
+            std::ptrdiff_t numUnknown = last - first;
+            std::ptrdiff_t leftSplit = numL == 0 ? (numR == 0 ? numUnknown / 2 : numUnknown) : 0;
+            std::ptrdiff_t rightSplit = numR == 0 ? (numUnknown - leftSplit) : 0;
+
+            leftSplit = std::min(leftSplit, PDQ_BLOCK_SIZE);
+            rightSplit = std::min(rightSplit, PDQ_BLOCK_SIZE);
+
+            // Record elements >= pivot on the left...
+            for (std::ptrdiff_t i = 0; i < leftSplit; i++) {
+                offsetsL[numL] = static_cast<unsigned char>(i);
+                numL += !comp(*first, pivot);
+                ++first;
+            }
+
+            // ...and elements < pivot on the right
+            for (std::ptrdiff_t i = 0; i < rightSplit; ) {
+                offsetsR[numR] = static_cast<unsigned char>(++i);
+                numR += comp(*--last, pivot);
+            }
+
+            std::ptrdiff_t num = std::min(numL, numR);
+            swapOffsets(offsetsLBase, offsetsRBase, offsetsL + startL, offsetsR + startR, num, numL == numR);
+            numL -= num;
+            numR -= num;
+            startL += num;
+            startR += num;
+
+            if (numL == 0) {
+                startL = 0;
+                offsetsLBase = first;
+            }
+            if (numR == 0) {
+                startR = 0;
+                offsetsRBase = last;
+            }
+        }
+
+        // Only one side can have leftovers; move them next to the boundary
+        if (numL) {
+            const unsigned char* offsets = offsetsL + startL;
+            while (numL--) std::iter_swap(offsetsLBase + offsets[numL], --last);
+            first = last;
+        }
+        if (numR) {
+            const unsigned char* offsets = offsetsR + startR;
+            while (numR--) std::iter_swap(offsetsRBase - offsets[numR], first), ++first;
+            last = first;
+        }
+    }
+
+    // Put the pivot in its final place
+    RandomIt pivotPos = first - 1;
+    *begin = std::move(*pivotPos);
+    *pivotPos = std::move(pivot);
+
+    return std::make_pair(pivotPos, alreadyPartitioned);
+}
+
+// Same contract as partitionRightBranchless, with a classic Hoare loop
+template <typename RandomIt, typename Compare>
+std::pair<RandomIt, bool> partitionRight(RandomIt begin, RandomIt end, Compare comp) {
+    ValueType<RandomIt> pivot = std::move(*begin);
+    RandomIt first = begin;
+    RandomIt last = end;
+
+    while (comp(*++first, pivot));
+
+    if (first - 1 == begin) {
+        while (first < last && !comp(*--last, pivot));
+    } else {
+        while (!comp(*--last, pivot));
+    }
+
+    bool alreadyPartitioned = first >= last;
+
+    while (first < last) {
+        std::iter_swap(first, last);
+        while (comp(*++first, pivot));
+        while (!comp(*--last, pivot));
+    }
+
+    RandomIt pivotPos = first - 1;
+    *begin = std::move(*pivotPos);
+    *pivotPos = std::move(pivot);
+
+    return std::make_pair(pivotPos, alreadyPartitioned);
+}
+
+// Partition with elements equal to the pivot going left. Used when the pivot
+// equals the element before the range, so everything equal to it is already
+// in place and only the larger elements need sorting.
+template <typename RandomIt, typename Compare>
+RandomIt partitionLeft(RandomIt begin, RandomIt end, Compare comp) {
+    ValueType<RandomIt> pivot = std::move(*begin);
+    RandomIt first = begin;
+    RandomIt last = end;
+
+    while (comp(pivot, *--last));
+
+    if (last + 1 == end) {
+        while (first < last && !comp(pivot, *++first));
+    } else {
+        while (!comp(pivot, *++first));
+    }
+
+    while (first < last) {
+        std::iter_swap(first, last);
+        while (comp(pivot, *--last));
+        while (!comp(pivot, *++first));
+    }
+
+    RandomIt pivotPos = last;
+    *begin = std::move(*pivotPos);
+    *pivotPos = std::move(pivot);
+
+    return pivotPos;
+}
+
+template <bool Branchless, typename RandomIt, typename Compare>
+void pdqSortLoop(RandomIt begin, RandomIt end, Compare comp, int badAllowed, bool leftmost) {
+    while (true) {
+        std::ptrdiff_t size = end - begin;
+
+        if (size < PDQ_INSERTION_SORT_THRESHOLD) {
+            if (leftmost)
+                insertionSort(begin, end, comp);
+            else
+                unguardedInsertionSort(begin, end, comp);
+            return;
+        }
+
+        // Median of 3, or pseudo-median of 9, moved to *begin
+        std::ptrdiff_t s2 = size / 2;
+        if (size > NINTHER_THRESHOLD) {
+            sort3(begin, begin + s2, end - 1, comp);
+            sort3(begin + 1, begin + (s2 - 1), end - 2, comp);
+            sort3(begin + 2, begin + (s2 + 1), end - 3, comp);
+            sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1), comp);
+            std::iter_swap(begin, begin + s2);
+        } else {
+            sort3(begin + s2, begin, end - 1, comp);
+        }
+
+        // If the pivot equals the element before this range, every element
+        // equal to it belongs here already: split them off in one pass
+        if (!leftmost && !comp(*(begin - 1), *begin)) {
+            begin = partitionLeft(begin, end, comp) + 1;
+            continue;
+        }
+
+        std::pair<RandomIt, bool> partResult = Branchless
+            ? partitionRightBranchless(begin, end, comp)
+            : partitionRight(begin, end, comp);
+        RandomIt pivotPos = partResult.first;
+        bool alreadyPartitioned = partResult.second;
+
+        std::ptrdiff_t lSize = pivotPos - begin;
+        std::ptrdiff_t rSize = end - (pivotPos + 1);
+        bool highlyUnbalanced = lSize < size / 8 || rSize < size / 8;
+
+        if (highlyUnbalanced) {
+            // Too many bad pivots: fall back to heap sort for O(n log n)
+            if (--badAllowed == 0) {
+                heapSort(begin, end, comp);
+                return;
+            }
+
+            // Break up patterns that fooled the pivot selection by swapping
+            // a few elements into the positions the next pivot will sample
+            if (lSize >= PDQ_INSERTION_SORT_THRESHOLD) {
+                std::iter_swap(begin, begin + lSize / 4);
+                std::iter_swap(pivotPos - 1, pivotPos - lSize / 4);
+
+                if (lSize > NINTHER_THRESHOLD) {
+                    std::iter_swap(begin + 1, begin + (lSize / 4 + 1));
+                    std::iter_swap(begin + 2, begin + (lSize / 4 + 2));
+                    std::iter_swap(pivotPos - 2, pivotPos - (lSize / 4 + 1));
+                    std::iter_swap(pivotPos - 3, pivotPos - (lSize / 4 + 2));
+                }
+            }
+
+            if (rSize >= PDQ_INSERTION_SORT_THRESHOLD) {
+                std::iter_swap(pivotPos + 1, pivotPos + (1 + rSize / 4));
+                std::iter_swap(end - 1, end - rSize / 4);
+
+                if (rSize > NINTHER_THRESHOLD) {
+                    std::iter_swap(pivotPos + 2, pivotPos + (2 + rSize / 4));
+                    std::iter_swap(pivotPos + 3, pivotPos + (3 + rSize / 4));
+                    std::iter_swap(end - 2, end - (1 + rSize / 4));
+                    std::iter_swap(end - 3, end - (2 + rSize / 4));
+                }
+            }
+        } else {
+            // A balanced partition that needed no swaps suggests the input is
+            // already (nearly) sorted: try to finish both sides cheaply
+            if (alreadyPartitioned && partialInsertionSort(begin, pivotPos, comp) &&
+                partialInsertionSort(pivotPos + 1, end, comp)) {
+                return;
+            }
+        }
+
+        // Recurse into the left side and loop on the right one
+        pdqSortLoop<Branchless>(begin, pivotPos, comp, badAllowed, leftmost);
+        begin = pivotPos + 1;
+        leftmost = false;
+    }
+}
+
+} // namespace detail
+
+// Pattern-defeating quicksort (pdqsort). Sorted, reverse sorted and
+// equal-key inputs take linear time; adversarial inputs are defused by
+// shuffling after bad pivots and, if that keeps failing, by heap sort.
+// Cheap comparisons on arithmetic keys use the branchless block partition.
+template <typename RandomIt, typename Compare = std::less<>>
+void pdqSort(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    if (last - first < 2) return;
+
+    constexpr bool branchless = detail::IsDefaultCompare<Compare>::value &&
+                                std::is_arithmetic<ValueType<RandomIt>>::value;
+    detail::pdqSortLoop<branchless>(first, last, comp, detail::introsortDepthLimit(last - first) / 2, true);
+}
+
+// Tim sort
+namespace detail {
+
+// Arrays shorter than this are sorted with a single binary insertion sort
+constexpr std::ptrdiff_t MIN_MERGE = 32;
+
+// Initial number of consecutive wins before a merge switches to galloping
+constexpr std::ptrdiff_t MIN_GALLOP = 7;
+
+// Minimum run length for an array of size n: a value in [MIN_MERGE/2, MIN_MERGE]
+// such that n / minRun is close to, but no larger than, a power of two
+inline std::ptrdiff_t timSortMinRun(std::ptrdiff_t n) {
+    std::ptrdiff_t r = 0;
+    while (n >= MIN_MERGE) {
+        r |= (n & 1);
+        n >>= 1;
+    }
+    return n + r;
+}
+
+// Sort [lo, hi) given that [lo, start) is already sorted, using binary search
+// to find each insertion point. Equal keys are inserted after existing ones.
+template <typename RandomIt, typename Compare>
+void binaryInsertionSort(RandomIt lo, RandomIt hi, RandomIt start, Compare comp) {
+    if (start == lo) ++start;
+
+    for (; start < hi; ++start) {
+        ValueType<RandomIt> pivot = std::move(*start);
+        RandomIt pos = std::upper_bound(lo, start, pivot, comp);
+        std::move_backward(pos, start, start + 1);
+        *pos = std::move(pivot);
+    }
+}
+
+// Sort [lo, hi) given that [lo, start) is a run, for extending short runs to
+// minRun: with a SIMD sorting network if one applies, else binary insertion
+template <typename RandomIt, typename Compare>
+void sortRunPrefix(RandomIt lo, RandomIt hi, RandomIt start, Compare comp) {
+    if constexpr (UsesIntNetwork<RandomIt, Compare>::value) {
+        if (simd::sortNetwork(&*lo, hi - lo)) return;
+    }
+    binaryInsertionSort(lo, hi, start, comp);
+}
+
+// Length of the run starting at lo. A strictly descending run is reversed in
+// place so every run on the stack is ascending; strictness keeps it stable.
+template <typename RandomIt, typename Compare>
+std::ptrdiff_t countRunAndMakeAscending(RandomIt lo, RandomIt hi, Compare comp) {
+    RandomIt runHi = lo + 1;
+    if (runHi == hi) return 1;
+
+    if (comp(*runHi, *lo)) {
+        ++runHi;
+        while (runHi < hi && comp(*runHi, *(runHi - 1))) ++runHi;
+        std::reverse(lo, runHi);
+    } else {
+        ++runHi;
+        while (runHi < hi && !comp(*runHi, *(runHi - 1))) ++runHi;
+    }
+
+    return runHi - lo;
+}
+
+// Leftmost position in the sorted range [base, base + len) at which key could
+// be inserted, searching outward from hint with exponentially growing steps
+template <typename T, typename It, typename Compare>
+std::ptrdiff_t gallopLeft(const T& key, It base, std::ptrdiff_t len, std::ptrdiff_t hint, Compare comp) {
+    std::ptrdiff_t lastOfs = 0;
+    std::ptrdiff_t ofs = 1;
+
+    if (comp(base[hint], key)) {
+        // Gallop right until base[hint + lastOfs] < key <= base[hint + ofs]
+        std::ptrdiff_t maxOfs = len - hint;
+        while (ofs < maxOfs && comp(base[hint + ofs], key)) {
+            lastOfs = ofs;
+            ofs = (ofs << 1) + 1;
+        }
+        if (ofs > maxOfs) ofs = maxOfs;
+        lastOfs += hint;
+        ofs += hint;
+    } else {
+        // Gallop left until base[hint - ofs] < key <= base[hint - lastOfs]
+        std::ptrdiff_t maxOfs = hint + 1;
+        while (ofs < maxOfs && !comp(base[hint - ofs], key)) {
+            lastOfs = ofs;
+            ofs = (ofs << 1) + 1;
+        }
+        if (ofs > maxOfs) ofs = maxOfs;
+        std::ptrdiff_t tmp = lastOfs;
+        lastOfs = hint - ofs;
+        ofs = hint - tmp;
+    }
+
+    // Binary search the remaining window (lastOfs, ofs]
+    lastOfs++;
+    while (lastOfs < ofs) {
+        std::ptrdiff_t m = lastOfs + (ofs - lastOfs) / 2;
+        if (comp(base[m], key))
+            lastOfs = m + 1;
+        else
+            ofs = m;
+    }
+    return ofs;
+}
+
+// Like gallopLeft, but returns the rightmost insertion point for key
+template <typename T, typename It, typename Compare>
+std::ptrdiff_t gallopRight(const T& key, It base, std::ptrdiff_t len, std::ptrdiff_t hint, Compare comp) {
+    std::ptrdiff_t lastOfs = 0;
+    std::ptrdiff_t ofs = 1;
+
+    if (comp(key, base[hint])) {
+        // Gallop left until base[hint - ofs] <= key < base[hint - lastOfs]
+        std::ptrdiff_t maxOfs = hint + 1;
+        while (ofs < maxOfs && comp(key, base[hint - ofs])) {
+            lastOfs = ofs;
+            ofs = (ofs << 1) + 1;
+        }
+        if (ofs > maxOfs) ofs = maxOfs;
+        std::ptrdiff_t tmp = lastOfs;
+        lastOfs = hint - ofs;
+        ofs = hint - tmp;
+    } else {
+        // Gallop right until base[hint + lastOfs] <= key < base[hint + ofs]
+        std::ptrdiff_t maxOfs = len - hint;
+        while (ofs < maxOfs && !comp(key, base[hint + ofs])) {
+            lastOfs = ofs;
+            ofs = (ofs << 1) + 1;
+        }
+        if (ofs > maxOfs) ofs = maxOfs;
+        lastOfs += hint;
+        ofs += hint;
+    }
+
+    lastOfs++;
+    while (lastOfs < ofs) {
+        std::ptrdiff_t m = lastOfs + (ofs - lastOfs) / 2;
+        if (comp(key, base[m]))
+            ofs = m;
+        else
+            lastOfs = m + 1;
+    }
+    return ofs;
+}
+
+// State of one tim sort call: the pending run stack, the adaptive gallop
+// threshold and the workspace that buffers the shorter run of each merge
+template <typename RandomIt, typename Compare>
+class TimSorter {
+public:
+    TimSorter(RandomIt first, SortWorkspace<ValueType<RandomIt>>& workspace, Compare comp)
+        : a(first), comp(comp), tmp(workspace) {}
+
+    void pushRun(std::ptrdiff_t base, std::ptrdiff_t len) {
+        runBase.push_back(base);
+        runLen.push_back(len);
+    }
+
+    // Merge runs until the stack invariants hold again:
+    //   runLen[i - 3] > runLen[i - 2] + runLen[i - 1]
+    //   runLen[i - 2] > runLen[i - 1]
+    void mergeCollapse() {
+        while (runLen.size() > 1) {
+            std::ptrdiff_t n = static_cast<std::ptrdiff_t>(runLen.size()) - 2;
+            if ((n > 0 && runLen[n - 1] <= runLen[n] + runLen[n + 1]) ||
+                (n > 1 && runLen[n - 2] <= runLen[n - 1] + runLen[n])) {
+                if (runLen[n - 1] < runLen[n + 1]) n--;
+            } else if (runLen[n] > runLen[n + 1]) {
+                break;
+            }
+            mergeAt(n);
+        }
+    }
+
+    // Merge everything left on the stack into a single run
+    void mergeForceCollapse() {
+        while (runLen.size() > 1) {
+            std::ptrdiff_t n = static_cast<std::ptrdiff_t>(runLen.size()) - 2;
+            if (n > 0 && runLen[n - 1] < runLen[n + 1]) n--;
+            mergeAt(n);
+        }
+    }
+
+private:
+    using T = ValueType<RandomIt>;
+
+    RandomIt a;
+    Compare comp;
+    std::ptrdiff_t minGallop = MIN_GALLOP;
+    SortWorkspace<T>& tmp;
+    std::vector<std::ptrdiff_t> runBase;
+    std::vector<std::ptrdiff_t> runLen;
+
+    // Merge the runs at stack positions i and i + 1
+    void mergeAt(std::ptrdiff_t i) {
+        std::ptrdiff_t base1 = runBase[i];
+        std::ptrdiff_t len1 = runLen[i];
+        std::ptrdiff_t base2 = runBase[i + 1];
+        std::ptrdiff_t len2 = runLen[i + 1];
+
+        runLen[i] = len1 + len2;
+        runBase.erase(runBase.begin() + i + 1);
+        runLen.erase(runLen.begin() + i + 1);
+
+        // Elements of run1 that are <= run2's first element are already in place
+        std::ptrdiff_t k = gallopRight(a[base2], a + base1, len1, 0, comp);
+        base1 += k;
+        len1 -= k;
+        if (len1 == 0) return;
+
+        // Elements of run2 that are >= run1's last element are already in place
+        len2 = gallopLeft(a[base1 + len1 - 1], a + base2, len2, len2 - 1, comp);
+        if (len2 == 0) return;
+
+        // Buffer the shorter run
+        if (len1 <= len2)
+            mergeLo(base1, len1, base2, len2);
+        else
+            mergeHi(base1, len1, base2, len2);
+    }
+
+    T* ensureCapacity(std::ptrdiff_t len) {
+        tmp.reserve(static_cast<std::size_t>(len));
+        return tmp.data();
+    }
+
+    // Merge left to right, with run1 (the shorter) copied to tmp
+    void mergeLo(std::ptrdiff_t base1, std::ptrdiff_t len1, std::ptrdiff_t base2, std::ptrdiff_t len2) {
+        auto t = ensureCapacity(len1);
+        std::move(a + base1, a + base1 + len1, t);
+
+        // Int runs go through the SIMD merge network instead of galloping;
+        // mergeAt has already trimmed the parts that were in place
+        if constexpr (UsesIntNetwork<RandomIt, Compare>::value) {
+            if (simd::mergeInts(t, len1, &a[base2], len2, &a[base1])) return;
+        }
+
+        auto cursor1 = t;
+        RandomIt cursor2 = a + base2;
+        RandomIt dest = a + base1;
+
+        *dest++ = std::move(*cursor2++);
+        if (--len2 == 0) {
+            std::move(cursor1, cursor1 + len1, dest);
+            return;
+        }
+        if (len1 == 1) {
+            dest = std::move(cursor2, cursor2 + len2, dest);
+            *dest = std::move(*cursor1);
+            return;
+        }
+
+        std::ptrdiff_t mg = minGallop;
+        while (true) {
+            std::ptrdiff_t count1 = 0; // wins in a row by run1
+            std::ptrdiff_t count2 = 0; // wins in a row by run2
+
+            // One element at a time until one run starts winning consistently
+            bool done = false;
+            do {
+                if (comp(*cursor2, *cursor1)) {
+                    *dest++ = std::move(*cursor2++);
+                    count2++;
+                    count1 = 0;
+                    if (--len2 == 0) { done = true; break; }
+                } else {
+                    *dest++ = std::move(*cursor1++);
+                    count1++;
+                    count2 = 0;
+                    if (--len1 == 1) { done = true; break; }
+                }
+            } while ((count1 | count2) < mg);
+            if (done) break;
+
+            // Galloping mode: copy whole blocks while either run keeps winning
+            do {
+                count1 = gallopRight(*cursor2, cursor1, len1, 0, comp);
+                if (count1 != 0) {
+                    dest = std::move(cursor1, cursor1 + count1, dest);
+                    cursor1 += count1;
+                    len1 -= count1;
+                    if (len1 <= 1) { done = true; break; }
+                }
+                *dest++ = std::move(*cursor2++);
+                if (--len2 == 0) { done = true; break; }
+
+                count2 = gallopLeft(*cursor1, cursor2, len2, 0, comp);
+                if (count2 != 0) {
+                    dest = std::move(cursor2, cursor2 + count2, dest);
+                    cursor2 += count2;
+                    len2 -= count2;
+                    if (len2 == 0) { done = true; break; }
+                }
+                *dest++ = std::move(*cursor1++);
+                if (--len1 == 1) { done = true; break; }
+                mg--;
+            } while (count1 >= MIN_GALLOP || count2 >= MIN_GALLOP);
+            if (done) break;
+
+            // Penalize leaving galloping mode
+            if (mg < 0) mg = 0;
+            mg += 2;
+        }
+        minGallop = mg < 1 ? 1 : mg;
+
+        if (len1 == 1) {
+            dest = std::move(cursor2, cursor2 + len2, dest);
+            *dest = std::move(*cursor1);
+        } else {
+            std::move(cursor1, cursor1 + len1, dest);
+        }
+    }
+
+    // Merge right to left, with run2 (the shorter) copied to tmp
+    void mergeHi(std::ptrdiff_t base1, std::ptrdiff_t len1, std::ptrdiff_t base2, std::ptrdiff_t len2) {
+        auto t = ensureCapacity(len2);
+        std::move(a + base2, a + base2 + len2, t);
+
+        if constexpr (UsesIntNetwork<RandomIt, Compare>::value) {
+            if (simd::mergeIntsBackward(&a[base1], len1, t, len2, &a[base1])) return;
+        }
+
+        RandomIt cursor1 = a + base1 + len1 - 1;
+        auto cursor2 = t + len2 - 1;
+        RandomIt dest = a + base2 + len2 - 1;
+
+        *dest-- = std::move(*cursor1--);
+        if (--len1 == 0) {
+            std::move(t, t + len2, dest - (len2 - 1));
+            return;
+        }
+        if (len2 == 1) {
+            dest -= len1;
+            cursor1 -= len1;
+            std::move_backward(cursor1 + 1, cursor1 + 1 + len1, dest + 1 + len1);
+            *dest = std::move(*cursor2);
+            return;
+        }
+
+        std::ptrdiff_t mg = minGallop;
+        while (true) {
+            std::ptrdiff_t count1 = 0;
+            std::ptrdiff_t count2 = 0;
+
+            bool done = false;
+            do {
+                if (comp(*cursor2, *cursor1)) {
+                    *dest-- = std::move(*cursor1--);
+                    count1++;
+                    count2 = 0;
+                    if (--len1 == 0) { done = true; break; }
+                } else {
+                    *dest-- = std::move(*cursor2--);
+                    count2++;
+                    count1 = 0;
+                    if (--len2 == 1) { done = true; break; }
+                }
+            } while ((count1 | count2) < mg);
+            if (done) break;
+
+            do {
+                count1 = len1 - gallopRight(*cursor2, a + base1, len1, len1 - 1, comp);
+                if (count1 != 0) {
+                    dest -= count1;
+                    cursor1 -= count1;
+                    len1 -= count1;
+                    std::move_backward(cursor1 + 1, cursor1 + 1 + count1, dest + 1 + count1);
+                    if (len1 == 0) { done = true; break; }
+                }
+                *dest-- = std::move(*cursor2--);
+                if (--len2 == 1) { done = true; break; }
+
+                count2 = len2 - gallopLeft(*cursor1, t, len2, len2 - 1, comp);
+                if (count2 != 0) {
+                    dest -= count2;
+                    cursor2 -= count2;
+                    len2 -= count2;
+                    std::move(cursor2 + 1, cursor2 + 1 + count2, dest + 1);
+                    if (len2 <= 1) { done = true; break; }
+                }
+                *dest-- = std::move(*cursor1--);
+                if (--len1 == 0) { done = true; break; }
+                mg--;
+            } while (count1 >= MIN_GALLOP || count2 >= MIN_GALLOP);
+            if (done) break;
+
+            if (mg < 0) mg = 0;
+            mg += 2;
+        }
+        minGallop = mg < 1 ? 1 : mg;
+
+        if (len2 == 1) {
+            dest -= len1;
+            cursor1 -= len1;
+            std::move_backward(cursor1 + 1, cursor1 + 1 + len1, dest + 1 + len1);
+            *dest = std::move(*cursor2);
+        } else {
+            std::move(t, t + len2, dest - (len2 - 1));
+        }
+    }
+};
+
+} // namespace detail
+
+// Natural merge sort: detects existing ascending/descending runs, extends
+// short runs to minRun with binary insertion sort (or a sorting network), and merges them from a
+// run stack with galloping, so sorted and nearly sorted input is close to O(n)
+template <typename RandomIt, typename Compare = std::less<>>
+void timSort(RandomIt first, RandomIt last, SortWorkspace<ValueType<RandomIt>>& workspace,
+             Compare comp = Compare()) {
+    std::ptrdiff_t n = last - first;
+    if (n < 2) return;
+
+    // Small arrays need no merging
+    if (n < detail::MIN_MERGE) {
+        std::ptrdiff_t initRunLen = detail::countRunAndMakeAscending(first, last, comp);
+        detail::sortRunPrefix(first, last, first + initRunLen, comp);
+        return;
+    }
+
+    detail::TimSorter<RandomIt, Compare> sorter(first, workspace, comp);
+    std::ptrdiff_t minRun = detail::timSortMinRun(n);
+    std::ptrdiff_t lo = 0;
+    std::ptrdiff_t remaining = n;
+
+    do {
+        // Identify the next run, extending it to minRun if it is short
+        std::ptrdiff_t runLen = detail::countRunAndMakeAscending(first + lo, last, comp);
+        if (runLen < minRun) {
+            std::ptrdiff_t force = std::min(remaining, minRun);
+            detail::sortRunPrefix(first + lo, first + lo + force, first + lo + runLen, comp);
+            runLen = force;
+        }
+
+        sorter.pushRun(lo, runLen);
+        sorter.mergeCollapse();
+
+        lo += runLen;
+        remaining -= runLen;
+    } while (remaining != 0);
+
+    sorter.mergeForceCollapse();
+}
+
+template <typename RandomIt, typename Compare = std::less<>>
+void timSort(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    SortWorkspace<ValueType<RandomIt>> workspace;
+    timSort(first, last, workspace, comp);
+}
+
+namespace detail {
+
+// Elements per leaf of the tournament; each leaf is sorted up front
+constexpr std::ptrdiff_t TOURNAMENT_LEAF_SIZE = 32;
+
+} // namespace detail
+
+// Tournament sort: the range is cut into short sorted leaves, and a loser
+// tree plays them off against each other for every output element. Leaves of
+// one element would make the tree five levels deeper, each level a match per
+// element. Ties go to the earlier leaf and the leaves are sorted stably (the
+// int networks cannot tell equal keys apart), so the sort is stable.
+template <typename RandomIt, typename Compare = std::less<>>
+void tournamentSort(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    std::ptrdiff_t n = last - first;
+    if (n <= 1) return;
+
+    using Buffer = std::vector<ValueType<RandomIt>>;
+    using Leaf = std::move_iterator<typename Buffer::iterator>;
+
+    Buffer values(std::make_move_iterator(first), std::make_move_iterator(last));
+    std::vector<std::pair<Leaf, Leaf>> leaves;
+    leaves.reserve((n + detail::TOURNAMENT_LEAF_SIZE - 1) / detail::TOURNAMENT_LEAF_SIZE);
+    for (std::ptrdiff_t start = 0; start < n; start += detail::TOURNAMENT_LEAF_SIZE) {
+        auto leafFirst = values.begin() + start;
+        auto leafLast = values.begin() + std::min(n, start + detail::TOURNAMENT_LEAF_SIZE);
+        detail::smallSort(leafFirst, leafLast, comp);
+        leaves.emplace_back(Leaf(leafFirst), Leaf(leafLast));
+    }
+    mergeRuns(std::move(leaves), first, comp);
+}
+
+// Library sort (gapped insertion sort)
+template <typename RandomIt, typename Compare = std::less<>>
+void librarySort(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    using T = ValueType<RandomIt>;
+
+    std::ptrdiff_t n = last - first;
+    if (n <= 1) return;
+
+    // Gap factor: every element is followed by epsilon empty slots after a rebalance
+    const std::ptrdiff_t epsilon = 1;
+
+    std::ptrdiff_t rounded = 1;
+    while (rounded < n) rounded <<= 1;
+    std::ptrdiff_t capacity = (1 + epsilon) * rounded;
+
+    std::vector<T> library(capacity);
+    std::vector<char> occupied(capacity, 0);
+    std::vector<T> scratch;
+    scratch.reserve(rounded);
+
+    // Spread the occupied slots of [0, span) evenly over [0, (1 + epsilon) * count)
+    auto rebalance = [&](std::ptrdiff_t span, std::ptrdiff_t count) {
+        scratch.clear();
+        for (std::ptrdiff_t i = 0; i < span; i++) {
+            if (occupied[i]) {
+                scratch.push_back(std::move(library[i]));
+                occupied[i] = 0;
+            }
+        }
+        for (std::ptrdiff_t i = 0; i < count; i++) {
+            std::ptrdiff_t pos = (1 + epsilon) * i + epsilon;
+            library[pos] = std::move(scratch[i]);
+            occupied[pos] = 1;
+        }
+        return (1 + epsilon) * count;
+    };
+
+    library[0] = std::move(*first);
+    occupied[0] = 1;
+    std::ptrdiff_t span = rebalance(1, 1);
+
+    for (std::ptrdiff_t count = 1; count < n; ) {
+        T element = std::move(first[count]);
+
+        // Binary search for the first occupied slot greater than element,
+        // stepping left over gaps to find a key to compare against
+        std::ptrdiff_t lo = 0;
+        std::ptrdiff_t hi = span;
+        while (lo < hi) {
+            std::ptrdiff_t mid = lo + (hi - lo) / 2;
+            std::ptrdiff_t m = mid;
+            while (m >= lo && !occupied[m]) m--;
+
+            if (m < lo) {
+                lo = mid + 1;
+            } else if (comp(element, library[m])) {
+                hi = m;
+            } else {
+                lo = mid + 1;
+            }
+        }
+
+        std::ptrdiff_t pos = lo;
+        if (pos > 0 && !occupied[pos - 1]) {
+            // A gap is free right before the insertion point
+            pos--;
+        } else if (pos == span || occupied[pos]) {
+            // Shift the run starting at pos one slot to the right, or the
+            // run ending at pos - 1 one slot to the left if there is no room
+            std::ptrdiff_t gap = pos;
+            while (gap < span && occupied[gap]) gap++;
+
+            if (gap < span) {
+                std::move_backward(library.begin() + pos, library.begin() + gap, library.begin() + gap + 1);
+                occupied[gap] = 1;
+            } else {
+                gap = pos - 1;
+                while (occupied[gap]) gap--;
+                std::move(library.begin() + gap + 1, library.begin() + pos, library.begin() + gap);
+                occupied[gap] = 1;
+                pos--;
+            }
+        }
+
+        library[pos] = std::move(element);
+        occupied[pos] = 1;
+        count++;
+
+        // Rebalance each time the element count reaches a power of two
+        if ((count & (count - 1)) == 0) {
+            span = rebalance(span, count);
+        }
+    }
+
+    // Copy occupied slots back in order
+    RandomIt out = first;
+    for (std::ptrdiff_t i = 0; i < span && out != last; i++) {
+        if (occupied[i]) {
+            *out++ = std::move(library[i]);
+        }
+    }
+}
+
+} // namespace sorting
+
+#endif // SORT_ALGORITHMS_H
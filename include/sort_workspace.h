@@ -0,0 +1,37 @@
+#ifndef SORT_WORKSPACE_H
+#define SORT_WORKSPACE_H
+
+#include <cstddef>
+#include <vector>
+
+namespace sorting {
+
+// Scratch memory for the merge-based sorts.
+//
+// A sort that is given a workspace grows it to the size it needs and never
+// shrinks it, so a caller that keeps one workspace alive across calls stops
+// allocating once it has seen its largest input.
+template <typename T>
+class SortWorkspace {
+public:
+    SortWorkspace() = default;
+    explicit SortWorkspace(std::size_t capacity) { reserve(capacity); }
+
+    // Make sure at least n elements of scratch space are available
+    void reserve(std::size_t n) {
+        if (buffer.size() < n) buffer.resize(n);
+    }
+
+    T* data() { return buffer.data(); }
+    std::size_t capacity() const { return buffer.size(); }
+
+    // Give the memory back
+    void release() { std::vector<T>().swap(buffer); }
+
+private:
+    std::vector<T> buffer;
+};
+
+} // namespace sorting
+
+#endif // SORT_WORKSPACE_H
@@ -4,9 +4,25 @@
 #include <vector>
 #include <string>
 #include <chrono>
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include "sort_workspace.h"
 
-// Common interface for all sorting algorithms
+class ThreadPool;
+
+// Element operations one sort performed, from an instrumented run (see
+// op_counter.h); counted is false for algorithms that are not instrumented
+struct OperationCounts {
+    unsigned long long comparisons = 0;
+    unsigned long long swaps = 0;
+    unsigned long long moves = 0; // copies and moves of elements
+    bool counted = false;
+};
+
+// Common interface for all sorting algorithms.
+// The concrete classes below adapt the templated implementations in
+// sort_algorithms.h to std::vector<int>.
 class SortingAlgorithm {
 public:
     virtual ~SortingAlgorithm() = default;
@@ -20,6 +36,14 @@ public:
     // Check if algorithm is stable
     virtual bool isStable() const = 0;
     
+    // Whether the average running time grows quadratically; the benchmark
+    // matrix skips these sorts above MatrixOptions::maxQuadraticSize
+    virtual bool isQuadratic() const { return false; }
+    
+    // Whether a sort allocates scratch space proportional to the input;
+    // the external sort halves its chunks for these
+    virtual bool usesLinearScratch() const { return false; }
+    
     // Time complexity information
     virtual std::string getBestCase() const = 0;
     virtual std::string getAverageCase() const = 0;
@@ -27,28 +51,51 @@ public:
     
     // Space complexity information
     virtual std::string getSpaceComplexity() const = 0;
+    
+    // Free scratch memory kept between calls, so the next sort allocates
+    // everything it uses
+    virtual void releaseMemory() {}
+    
+    // Number of threads a sort runs on
+    virtual size_t getThreadCount() const { return 1; }
+    
+    // Sort an instrumented copy of data and count the element operations.
+    // Algorithms that do not work on comparisons leave the counts empty.
+    virtual OperationCounts countOperations(const std::vector<int>& data) {
+        (void)data;
+        return OperationCounts();
+    }
 };
 
 // Concrete implementations of sorting algorithms
 class MergeSort : public SortingAlgorithm {
 public:
     void sort(std::vector<int>& arr) override;
+    OperationCounts countOperations(const std::vector<int>& data) override;
     std::string getName() const override { return "Merge Sort"; }
     bool isStable() const override { return true; }
+    bool usesLinearScratch() const override { return true; }
     std::string getBestCase() const override { return "O(n log n)"; }
     std::string getAverageCase() const override { return "O(n log n)"; }
     std::string getWorstCase() const override { return "O(n log n)"; }
     std::string getSpaceComplexity() const override { return "O(n)"; }
 
+    void releaseMemory() override { workspace.release(); }
+
 private:
-    void mergeSort(std::vector<int>& arr, int left, int right);
-    void merge(std::vector<int>& arr, int left, int mid, int right);
+    // Scratch buffer kept across calls, so repeated sorts do not allocate
+    sorting::SortWorkspace<int> workspace;
 };
 
 class HeapSort : public SortingAlgorithm {
 public:
+    // arity is the children per heap node: 2 sifts top-down on a binary
+    // heap, 4 and 8 bottom-up on a cache-line-aligned d-ary heap
+    explicit HeapSort(int arity = 2);
+
     void sort(std::vector<int>& arr) override;
-    std::string getName() const override { return "Heap Sort"; }
+    OperationCounts countOperations(const std::vector<int>& data) override;
+    std::string getName() const override;
     bool isStable() const override { return false; }
     std::string getBestCase() const override { return "O(n log n)"; }
     std::string getAverageCase() const override { return "O(n log n)"; }
@@ -56,29 +103,72 @@ public:
     std::string getSpaceComplexity() const override { return "O(1)"; }
 
 private:
-    void heapify(std::vector<int>& arr, int n, int i);
+    int arity;
 };
 
 class QuickSort : public SortingAlgorithm {
 public:
     void sort(std::vector<int>& arr) override;
+    OperationCounts countOperations(const std::vector<int>& data) override;
     std::string getName() const override { return "Quick Sort"; }
     bool isStable() const override { return false; }
     std::string getBestCase() const override { return "O(n log n)"; }
     std::string getAverageCase() const override { return "O(n log n)"; }
-    std::string getWorstCase() const override { return "O(n²)"; }
+    std::string getWorstCase() const override { return "O(n log n)"; }
     std::string getSpaceComplexity() const override { return "O(log n)"; }
+};
+
+class PdqSort : public SortingAlgorithm {
+public:
+    void sort(std::vector<int>& arr) override;
+    OperationCounts countOperations(const std::vector<int>& data) override;
+    std::string getName() const override { return "Pdq Sort"; }
+    bool isStable() const override { return false; }
+    std::string getBestCase() const override { return "O(n)"; }
+    std::string getAverageCase() const override { return "O(n log n)"; }
+    std::string getWorstCase() const override { return "O(n log n)"; }
+    std::string getSpaceComplexity() const override { return "O(log n)"; }
+};
+
+class LsdRadixSort : public SortingAlgorithm {
+public:
+    // digitBits is the digit width per pass: 8, 11 or 16
+    explicit LsdRadixSort(int digitBits = 11);
+
+    void sort(std::vector<int>& arr) override;
+    std::string getName() const override { return "LSD Radix Sort"; }
+    bool isStable() const override { return true; }
+    bool usesLinearScratch() const override { return true; }
+    std::string getBestCase() const override { return "O(nk)"; }
+    std::string getAverageCase() const override { return "O(nk)"; }
+    std::string getWorstCase() const override { return "O(nk)"; }
+    std::string getSpaceComplexity() const override { return "O(n + 2^d)"; }
+
+    void releaseMemory() override { workspace.release(); }
 
 private:
-    void quickSort(std::vector<int>& arr, int low, int high);
-    int partition(std::vector<int>& arr, int low, int high);
+    int digitBits;
+    sorting::SortWorkspace<int> workspace;
+};
+
+class MsdRadixSort : public SortingAlgorithm {
+public:
+    void sort(std::vector<int>& arr) override;
+    std::string getName() const override { return "MSD Radix Sort"; }
+    bool isStable() const override { return false; }
+    std::string getBestCase() const override { return "O(n)"; }
+    std::string getAverageCase() const override { return "O(nk)"; }
+    std::string getWorstCase() const override { return "O(nk)"; }
+    std::string getSpaceComplexity() const override { return "O(k·2^d)"; }
 };
 
 class BubbleSort : public SortingAlgorithm {
 public:
     void sort(std::vector<int>& arr) override;
+    OperationCounts countOperations(const std::vector<int>& data) override;
     std::string getName() const override { return "Bubble Sort"; }
     bool isStable() const override { return true; }
+    bool isQuadratic() const override { return true; }
     std::string getBestCase() const override { return "O(n)"; }
     std::string getAverageCase() const override { return "O(n²)"; }
     std::string getWorstCase() const override { return "O(n²)"; }
@@ -88,8 +178,10 @@ public:
 class InsertionSort : public SortingAlgorithm {
 public:
     void sort(std::vector<int>& arr) override;
+    OperationCounts countOperations(const std::vector<int>& data) override;
     std::string getName() const override { return "Insertion Sort"; }
     bool isStable() const override { return true; }
+    bool isQuadratic() const override { return true; }
     std::string getBestCase() const override { return "O(n)"; }
     std::string getAverageCase() const override { return "O(n²)"; }
     std::string getWorstCase() const override { return "O(n²)"; }
@@ -99,8 +191,10 @@ public:
 class SelectionSort : public SortingAlgorithm {
 public:
     void sort(std::vector<int>& arr) override;
+    OperationCounts countOperations(const std::vector<int>& data) override;
     std::string getName() const override { return "Selection Sort"; }
     bool isStable() const override { return false; }
+    bool isQuadratic() const override { return true; }
     std::string getBestCase() const override { return "O(n²)"; }
     std::string getAverageCase() const override { return "O(n²)"; }
     std::string getWorstCase() const override { return "O(n²)"; }
@@ -109,37 +203,42 @@ public:
 class LibrarySort : public SortingAlgorithm {
     public:
         void sort(std::vector<int>& arr) override;
+        OperationCounts countOperations(const std::vector<int>& data) override;
         std::string getName() const override { return "Library Sort"; }
         bool isStable() const override { return true; }
+        bool usesLinearScratch() const override { return true; }
         std::string getBestCase() const override { return "O(n)"; }
         std::string getAverageCase() const override { return "O(n log n)"; }
         std::string getWorstCase() const override { return "O(n²)"; }
         std::string getSpaceComplexity() const override { return "O(n)"; }
-    
-    private:
-        void rebalance(std::vector<std::pair<int, bool>>& library, size_t count);
     };
     
     class TimSort : public SortingAlgorithm {
     public:
         void sort(std::vector<int>& arr) override;
+        OperationCounts countOperations(const std::vector<int>& data) override;
         std::string getName() const override { return "Tim Sort"; }
         bool isStable() const override { return true; }
+        bool usesLinearScratch() const override { return true; }
         std::string getBestCase() const override { return "O(n)"; }
         std::string getAverageCase() const override { return "O(n log n)"; }
         std::string getWorstCase() const override { return "O(n log n)"; }
         std::string getSpaceComplexity() const override { return "O(n)"; }
     
+        void releaseMemory() override { workspace.release(); }
+
     private:
-        void insertionSort(std::vector<int>& arr, int left, int right);
-        void merge(std::vector<int>& arr, int left, int mid, int right);
+        // Scratch buffer kept across calls, so repeated sorts do not allocate
+        sorting::SortWorkspace<int> workspace;
     };
     
     class CocktailSort : public SortingAlgorithm {
         public:
             void sort(std::vector<int>& arr) override;  // Declaration of sort function
+            OperationCounts countOperations(const std::vector<int>& data) override;
             std::string getName() const override { return "Cocktail Shaker Sort"; }
             bool isStable() const override { return true; }
+            bool isQuadratic() const override { return true; }
             std::string getBestCase() const override { return "O(n)"; }
             std::string getAverageCase() const override { return "O(n²)"; }
             std::string getWorstCase() const override { return "O(n²)"; }
@@ -150,6 +249,7 @@ class LibrarySort : public SortingAlgorithm {
     class CombSort : public SortingAlgorithm {
     public:
         void sort(std::vector<int>& arr) override;
+        OperationCounts countOperations(const std::vector<int>& data) override;
         std::string getName() const override { return "Comb Sort"; }
         bool isStable() const override { return false; }
         std::string getBestCase() const override { return "O(n log n)"; }
@@ -161,29 +261,155 @@ class LibrarySort : public SortingAlgorithm {
 class TournamentSort : public SortingAlgorithm {
     public:
         void sort(std::vector<int>& arr) override;
+        OperationCounts countOperations(const std::vector<int>& data) override;
         std::string getName() const override { return "Tournament Sort"; }
-        bool isStable() const override { return false; }
+        bool isStable() const override { return true; }
+        bool usesLinearScratch() const override { return true; }
         std::string getBestCase() const override { return "O(n log n)"; }
         std::string getAverageCase() const override { return "O(n log n)"; }
         std::string getWorstCase() const override { return "O(n log n)"; }
         std::string getSpaceComplexity() const override { return "O(n)"; }
-    
-    private:
-        void buildTournamentTree(std::vector<int>& tree, int leafStart);
-        void rebuildTournamentTree(std::vector<int>& tree, int index);
     };
 
+class ParallelMergeSort : public SortingAlgorithm {
+public:
+    // threadCount == 0 uses every hardware thread
+    explicit ParallelMergeSort(size_t threadCount = 0);
+    ~ParallelMergeSort() override;
+
+    void sort(std::vector<int>& arr) override;
+    OperationCounts countOperations(const std::vector<int>& data) override;
+    std::string getName() const override { return "Parallel Merge Sort"; }
+    bool isStable() const override { return true; }
+    bool usesLinearScratch() const override { return true; }
+    std::string getBestCase() const override { return "O(n log n)"; }
+    std::string getAverageCase() const override { return "O(n log n)"; }
+    std::string getWorstCase() const override { return "O(n log n)"; }
+    std::string getSpaceComplexity() const override { return "O(n)"; }
+
+    size_t getThreadCount() const override;
+
+    void releaseMemory() override { workspace.release(); }
+
+private:
+    std::unique_ptr<ThreadPool> pool;
+    sorting::SortWorkspace<int> workspace;
+};
+
+class ParallelQuickSort : public SortingAlgorithm {
+public:
+    // threadCount == 0 uses every hardware thread
+    explicit ParallelQuickSort(size_t threadCount = 0);
+    ~ParallelQuickSort() override;
+
+    void sort(std::vector<int>& arr) override;
+    OperationCounts countOperations(const std::vector<int>& data) override;
+    std::string getName() const override { return "Parallel Quick Sort"; }
+    bool isStable() const override { return false; }
+    std::string getBestCase() const override { return "O(n log n)"; }
+    std::string getAverageCase() const override { return "O(n log n)"; }
+    std::string getWorstCase() const override { return "O(n log n)"; }
+    std::string getSpaceComplexity() const override { return "O(log n)"; }
+
+    size_t getThreadCount() const override;
+
+private:
+    std::unique_ptr<ThreadPool> pool;
+};
+
+class ParallelRadixSort : public SortingAlgorithm {
+public:
+    // threadCount == 0 uses every hardware thread
+    explicit ParallelRadixSort(size_t threadCount = 0);
+    ~ParallelRadixSort() override;
+
+    void sort(std::vector<int>& arr) override;
+    std::string getName() const override { return "Parallel Radix Sort"; }
+    bool isStable() const override { return true; }
+    bool usesLinearScratch() const override { return true; }
+    std::string getBestCase() const override { return "O(nk)"; }
+    std::string getAverageCase() const override { return "O(nk)"; }
+    std::string getWorstCase() const override { return "O(nk)"; }
+    std::string getSpaceComplexity() const override { return "O(n + p·2^d)"; }
+
+    size_t getThreadCount() const override;
+
+    void releaseMemory() override { workspace.release(); }
+
+private:
+    std::unique_ptr<ThreadPool> pool;
+    sorting::SortWorkspace<int> workspace;
+};
+
+
+// Distribution of the time of one sort over a benchmark's timed samples,
+// after outlier rejection
+struct TimingStats {
+    double minMs = 0.0;
+    double medianMs = 0.0;
+    double meanMs = 0.0;
+    double p90Ms = 0.0;
+    double p99Ms = 0.0;
+    double stddevMs = 0.0;
+    int samples = 0;        // samples kept
+    int outliers = 0;       // samples rejected as outliers
+    int sortsPerSample = 1; // sorts timed together in one sample
+};
+
+// Hardware event counts of one sort, averaged over a benchmark's samples.
+// A count is negative when its counter could not be opened.
+struct PerfCounts {
+    double cycles = -1.0;
+    double instructions = -1.0;
+    double branchMisses = -1.0;
+    double l1dMisses = -1.0;
+    double llcMisses = -1.0;
+    double dtlbMisses = -1.0;
+
+    // Instructions per cycle, or -1 if either count is missing
+    double ipc() const {
+        return (cycles > 0.0 && instructions >= 0.0) ? instructions / cycles : -1.0;
+    }
+
+    // A count divided by the number of elements sorted, or -1 if missing
+    static double perElement(double count, size_t elements) {
+        return (count >= 0.0 && elements > 0) ? count / static_cast<double>(elements) : -1.0;
+    }
+};
+
+// Heap use of one sort, from the counting operator new in alloc_tracker.cpp
+struct AllocationStats {
+    size_t bytesAllocated = 0;  // total bytes requested
+    size_t peakLiveBytes = 0;   // most bytes live at once, above what was live before
+    size_t allocationCount = 0;
+};
 
 // Helper struct to store performance metrics
 struct SortingResult {
     std::string algorithmName;
-    double executionTimeMs;
-    size_t memoryUsageBytes;
+    double executionTimeMs; // median time of one sort
+    size_t memoryUsageBytes; // peak extra heap memory of one sort
     bool isStable;
     bool isSorted;
+
+    // Data set the sort ran on; left empty when the caller does not record it
+    std::string dataSetName;
+    size_t dataSize = 0;
+    // Seed the data set was generated from, when recorded
+    std::uint64_t dataSeed = 0;
+    bool hasDataSeed = false;
+
+    // Threads the sort ran on
+    size_t threads = 1;
+
+    TimingStats timing;
+    PerfCounts counters;
+    AllocationStats allocations;
+    OperationCounts operations;
 };
 
-// Run benchmark on a specific algorithm with the given data
+// Run benchmark on a specific algorithm with the given data, using the
+// default BenchmarkConfig (see benchmark.h)
 SortingResult runSortingBenchmark(
     SortingAlgorithm& algorithm, 
     const std::vector<int>& originalData,
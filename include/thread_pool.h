@@ -0,0 +1,99 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool for fork-join parallelism.
+//
+// Every worker owns a deque. Tasks submitted from a worker go to the back of
+// its own deque and are popped from the back (newest first, which keeps the
+// working set hot); idle workers steal from the front of other deques, taking
+// the oldest and therefore largest pieces of work. Tasks submitted from
+// outside the pool go to a shared injection queue.
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    // threadCount == 0 uses std::thread::hardware_concurrency()
+    explicit ThreadPool(std::size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of worker threads
+    std::size_t size() const { return workers.size(); }
+
+    void submit(Task task);
+
+    // Run one queued task on the calling thread, if there is one.
+    // Threads blocked on a TaskGroup call this so they help instead of idling.
+    bool runPendingTask();
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    // queues[0] is the injection queue, queues[i + 1] belongs to worker i
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::atomic<std::size_t> queuedTasks{0};
+    std::atomic<bool> stopping{false};
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+
+    void workerLoop(std::size_t index);
+    bool popLocal(std::size_t queue, Task& task);
+    bool steal(std::size_t thief, Task& task);
+    std::size_t currentQueue() const;
+};
+
+// A set of tasks that can be waited on together.
+// wait() executes queued tasks while it waits, so nested fork-join is safe.
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool) : pool(pool) {}
+    ~TaskGroup() { drain(); }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    template <typename F>
+    void run(F&& f) {
+        pending.fetch_add(1, std::memory_order_relaxed);
+        pool.submit([this, task = std::forward<F>(f)]() mutable {
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) error = std::current_exception();
+            }
+            pending.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    // Block until every task has finished; rethrows the first task exception
+    void wait();
+
+private:
+    ThreadPool& pool;
+    std::atomic<std::size_t> pending{0};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    void drain();
+};
+
+#endif // THREAD_POOL_H
@@ -1,15 +1,55 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <cstdint>
+#include <ostream>
 #include <vector>
 #include <string>
 #include <random>
+#include "run_metadata.h"
 #include "sorting.h"
 
-// Generate test data
+// Seed from std::random_device, for runs not given one
+std::uint64_t randomSeed();
+
+// Generate test data. The overloads without a seed draw one with
+// randomSeed(); the seeded ones always produce the same data, whatever the
+// platform or thread count (see random_stream.h).
 std::vector<int> generateRandomData(size_t size, int min = 0, int max = 1000);
+std::vector<int> generateRandomData(size_t size, int min, int max, std::uint64_t seed);
 std::vector<int> generateSortedData(size_t size, bool ascending = true);
 std::vector<int> generatePartiallySortedData(size_t size, double sortedRatio = 0.7);
+std::vector<int> generatePartiallySortedData(size_t size, double sortedRatio, std::uint64_t seed);
+
+// Values drawn uniformly from the whole int range, so nearly all distinct
+std::vector<int> generateUniformData(size_t size, std::uint64_t seed);
+
+// size keys spread over the int range, the k-th most frequent drawn with
+// probability proportional to 1 / k^exponent
+std::vector<int> generateZipfData(size_t size, double exponent, std::uint64_t seed);
+
+// Only uniqueKeys distinct values, evenly mixed
+std::vector<int> generateFewUniquesData(size_t size, size_t uniqueKeys, std::uint64_t seed);
+
+// Every element equal
+std::vector<int> generateAllEqualData(size_t size);
+
+// Ascending to the middle, then descending
+std::vector<int> generateOrganPipeData(size_t size);
+
+// Ascending ramps 0, 1, ..., period - 1, repeated
+std::vector<int> generateSawtoothData(size_t size, size_t period);
+
+// Random values, sorted within consecutive runs of runLength elements
+std::vector<int> generateRandomRunsData(size_t size, size_t runLength, std::uint64_t seed);
+
+// Sorted data followed by a tail of random values, tailRatio of the total
+std::vector<int> generateSortedTailData(size_t size, double tailRatio, std::uint64_t seed);
+
+// Input built by McIlroy's adversary ("A Killer Adversary for Quicksort")
+// against sorting::quickSort: every pivot it picks is as bad as possible,
+// which drives the sort to its heap sort fallback
+std::vector<int> generateQuicksortKillerData(size_t size);
 
 // Validate if array is sorted
 bool isSorted(const std::vector<int>& arr, bool ascending = true);
@@ -17,23 +57,70 @@ bool isSorted(const std::vector<int>& arr, bool ascending = true);
 // Print array (for debugging)
 void printArray(const std::vector<int>& arr, size_t limit = 10);
 
-// Get current memory usage (platform dependent)
+// Peak resident set size of the process (platform dependent). The benchmark
+// measures per-sort heap use with AllocationScope instead (alloc_tracker.h).
 size_t getCurrentMemoryUsage();
 
-// Data set type enum
+// Data set type enum. RANDOM draws from [0, 1000], so large random data sets
+// are dominated by duplicates; UNIFORM covers the whole int range.
+// New types go at the end: the command line derives seeds from the values.
 enum class DataSetType {
     RANDOM,
     SORTED_ASC,
     SORTED_DESC,
-    PARTIALLY_SORTED
+    PARTIALLY_SORTED,
+    UNIFORM,
+    ZIPF,
+    FEW_UNIQUES,
+    ALL_EQUAL,
+    ORGAN_PIPE,
+    SAWTOOTH,
+    RANDOM_RUNS,
+    SORTED_TAIL,
+    QUICKSORT_KILLER
+};
+
+// Shape parameters of the generated data sets
+struct DataSetParams {
+    double zipfExponent = 1.0;  // ZIPF
+    size_t uniqueKeys = 16;     // FEW_UNIQUES
+    size_t runLength = 1000;    // RANDOM_RUNS, and the period of SAWTOOTH
+    double tailRatio = 0.01;    // SORTED_TAIL
 };
 
+// Every data set type, in menu order
+const std::vector<DataSetType>& allDataSetTypes();
+
+// Display name of a data set type, e.g. "Sorted (Asc)"
+std::string dataSetName(DataSetType type);
+
+// Short command-line key of a data set type, e.g. "sorted-asc"
+std::string dataSetKey(DataSetType type);
+
 // Generate data set of specified type and size
 std::vector<int> generateDataSet(DataSetType type, size_t size);
+std::vector<int> generateDataSet(DataSetType type, size_t size, std::uint64_t seed);
+std::vector<int> generateDataSet(DataSetType type, size_t size, std::uint64_t seed,
+                                 const DataSetParams& params);
+
+// Algorithm name with the data set appended when the result records one,
+// e.g. "Merge Sort [Random, n=1000]"
+std::string resultLabel(const SortingResult& result);
 
 // Pretty-print the results
 void printResults(const std::vector<SortingResult>& results);
 
+// Write results as CSV (the header line is left out when appending to an
+// existing file), or as a JSON array with one object per result
+void writeResultsCSV(std::ostream& out, const std::vector<SortingResult>& results, bool header = true);
+void writeResultsJSON(std::ostream& out, const std::vector<SortingResult>& results);
+
+// Write results as JSON Lines: one self-contained object per line, carrying
+// the run's metadata along with the result, so files can be appended to and
+// concatenated
+void writeResultsJSONLines(std::ostream& out, const std::vector<SortingResult>& results,
+                           const RunMetadata& metadata);
+
 // Save results to CSV file
 void saveResultsToCSV(const std::vector<SortingResult>& results, const std::string& filename);
 
@@ -43,7 +130,8 @@ std::vector<SortingResult> runAllAlgorithms(
     const std::vector<int>& data
 );
 
-// Run a specific algorithm on all data set types with multiple runs
+// Run a specific algorithm on all data set types, taking numRuns timed
+// samples of each
 std::vector<SortingResult> runAlgorithmOnAllDataSets(
     SortingAlgorithm& algorithm,
     const std::vector<size_t>& sizes,
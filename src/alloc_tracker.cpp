@@ -0,0 +1,141 @@
+#include "../include/alloc_tracker.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<size_t> totalBytes{0};
+std::atomic<size_t> totalCount{0};
+std::atomic<size_t> liveBytes{0};
+std::atomic<size_t> peakBytes{0};
+
+// Every block starts with a header holding the requested size, right before
+// the pointer handed out. Aligned blocks pad the header to their alignment.
+constexpr size_t HEADER = 16;
+static_assert(HEADER >= sizeof(size_t) && HEADER % alignof(std::max_align_t) == 0,
+              "header must keep the default new alignment");
+
+void recordAllocation(size_t size) {
+    totalBytes.fetch_add(size, std::memory_order_relaxed);
+    totalCount.fetch_add(1, std::memory_order_relaxed);
+
+    size_t live = liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    size_t peak = peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+// Allocate size bytes aligned to align (a power of two, at least HEADER)
+void* allocate(size_t size, size_t align) {
+    if (size > SIZE_MAX - 2 * align) {
+        return nullptr;
+    }
+
+    while (true) {
+        void* raw = align == HEADER ? std::malloc(size + HEADER)
+                                    : std::aligned_alloc(align, (size + align + align - 1) & ~(align - 1));
+        if (raw) {
+            char* block = static_cast<char*>(raw) + align;
+            *reinterpret_cast<size_t*>(block - HEADER) = size;
+            recordAllocation(size);
+            return block;
+        }
+
+        // Same retry protocol as the standard operator new
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            return nullptr;
+        }
+        handler();
+    }
+}
+
+void deallocate(void* ptr, size_t align) {
+    if (!ptr) {
+        return;
+    }
+    char* block = static_cast<char*>(ptr);
+    size_t size = *reinterpret_cast<size_t*>(block - HEADER);
+    liveBytes.fetch_sub(size, std::memory_order_relaxed);
+    std::free(block - align);
+}
+
+size_t alignmentOf(std::align_val_t align) {
+    size_t value = static_cast<size_t>(align);
+    return value < HEADER ? HEADER : value;
+}
+
+void* allocateOrThrow(size_t size, size_t align) {
+    void* ptr = allocate(size, align);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* allocateNoThrow(size_t size, size_t align) noexcept {
+    try {
+        return allocate(size, align);
+    } catch (...) {
+        // A new_handler may throw
+        return nullptr;
+    }
+}
+
+} // namespace
+
+size_t liveHeapBytes() {
+    return liveBytes.load(std::memory_order_relaxed);
+}
+
+AllocationScope::AllocationScope()
+    : startBytes(totalBytes.load(std::memory_order_relaxed)),
+      startCount(totalCount.load(std::memory_order_relaxed)),
+      baselineLive(liveBytes.load(std::memory_order_relaxed)) {
+    peakBytes.store(baselineLive, std::memory_order_relaxed);
+}
+
+AllocationStats AllocationScope::stats() const {
+    AllocationStats stats;
+    stats.bytesAllocated = totalBytes.load(std::memory_order_relaxed) - startBytes;
+    stats.allocationCount = totalCount.load(std::memory_order_relaxed) - startCount;
+    size_t peak = peakBytes.load(std::memory_order_relaxed);
+    stats.peakLiveBytes = peak > baselineLive ? peak - baselineLive : 0;
+    return stats;
+}
+
+// Replacement global allocation functions
+
+void* operator new(size_t size) { return allocateOrThrow(size, HEADER); }
+void* operator new[](size_t size) { return allocateOrThrow(size, HEADER); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocateNoThrow(size, HEADER); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocateNoThrow(size, HEADER); }
+
+void* operator new(size_t size, std::align_val_t align) { return allocateOrThrow(size, alignmentOf(align)); }
+void* operator new[](size_t size, std::align_val_t align) { return allocateOrThrow(size, alignmentOf(align)); }
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return allocateNoThrow(size, alignmentOf(align));
+}
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return allocateNoThrow(size, alignmentOf(align));
+}
+
+void operator delete(void* ptr) noexcept { deallocate(ptr, HEADER); }
+void operator delete[](void* ptr) noexcept { deallocate(ptr, HEADER); }
+void operator delete(void* ptr, size_t) noexcept { deallocate(ptr, HEADER); }
+void operator delete[](void* ptr, size_t) noexcept { deallocate(ptr, HEADER); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { deallocate(ptr, HEADER); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { deallocate(ptr, HEADER); }
+
+void operator delete(void* ptr, std::align_val_t align) noexcept { deallocate(ptr, alignmentOf(align)); }
+void operator delete[](void* ptr, std::align_val_t align) noexcept { deallocate(ptr, alignmentOf(align)); }
+void operator delete(void* ptr, size_t, std::align_val_t align) noexcept { deallocate(ptr, alignmentOf(align)); }
+void operator delete[](void* ptr, size_t, std::align_val_t align) noexcept { deallocate(ptr, alignmentOf(align)); }
+void operator delete(void* ptr, std::align_val_t align, const std::nothrow_t&) noexcept {
+    deallocate(ptr, alignmentOf(align));
+}
+void operator delete[](void* ptr, std::align_val_t align, const std::nothrow_t&) noexcept {
+    deallocate(ptr, alignmentOf(align));
+}
@@ -0,0 +1,348 @@
+#include "../include/benchmark.h"
+#include "../include/alloc_tracker.h"
+#include "../include/perf_counters.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+// Lets concurrent benchmarks run side by side while the measurements of
+// process-wide state (heap use, operation counts) run alone. Participating
+// threads hold the gate shared and trade it for exclusive access around such
+// a measurement. Exclusive requests take priority, so the other threads stop
+// at their next attempt to take the gate.
+class MeasurementGate {
+public:
+    void lockShared() {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this] { return !exclusive && waitingExclusive == 0; });
+        shared++;
+    }
+
+    void unlockShared() {
+        std::lock_guard<std::mutex> lock(mutex);
+        shared--;
+        changed.notify_all();
+    }
+
+    void lock() {
+        std::unique_lock<std::mutex> lock(mutex);
+        waitingExclusive++;
+        changed.wait(lock, [this] { return !exclusive && shared == 0; });
+        waitingExclusive--;
+        exclusive = true;
+    }
+
+    void unlock() {
+        std::lock_guard<std::mutex> lock(mutex);
+        exclusive = false;
+        changed.notify_all();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable changed;
+    int shared = 0;
+    int waitingExclusive = 0;
+    bool exclusive = false;
+};
+
+static MeasurementGate measurementGate;
+
+ConcurrentBenchmarkScope::ConcurrentBenchmarkScope() {
+    measurementGate.lockShared();
+}
+
+ConcurrentBenchmarkScope::~ConcurrentBenchmarkScope() {
+    measurementGate.unlockShared();
+}
+
+// Runs its scope with every other concurrent benchmark paused, when the
+// benchmark is concurrent
+class ExclusiveSection {
+public:
+    explicit ExclusiveSection(bool concurrent) : held(concurrent) {
+        if (held) {
+            measurementGate.unlockShared();
+            measurementGate.lock();
+        }
+    }
+
+    ~ExclusiveSection() {
+        if (held) {
+            measurementGate.unlock();
+            measurementGate.lockShared();
+        }
+    }
+
+    ExclusiveSection(const ExclusiveSection&) = delete;
+    ExclusiveSection& operator=(const ExclusiveSection&) = delete;
+
+private:
+    bool held;
+};
+
+// Value at quantile q of sorted samples, interpolating between closest ranks
+static double percentile(const std::vector<double>& sorted, double q) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    double rank = q * static_cast<double>(sorted.size() - 1);
+    size_t lower = static_cast<size_t>(rank);
+    size_t upper = std::min(lower + 1, sorted.size() - 1);
+    double fraction = rank - static_cast<double>(lower);
+    return sorted[lower] + (sorted[upper] - sorted[lower]) * fraction;
+}
+
+TimingStats summarizeSamples(std::vector<double> samplesMs, double outlierCutoff) {
+    TimingStats stats;
+    if (samplesMs.empty()) {
+        return stats;
+    }
+
+    std::sort(samplesMs.begin(), samplesMs.end());
+    double median = percentile(samplesMs, 0.5);
+
+    // Median absolute deviation; when more than half the samples are equal
+    // it is 0 and nothing is rejected
+    std::vector<double> deviations;
+    for (double sample : samplesMs) {
+        deviations.push_back(std::fabs(sample - median));
+    }
+    std::sort(deviations.begin(), deviations.end());
+    double mad = percentile(deviations, 0.5);
+
+    std::vector<double> kept;
+    for (double sample : samplesMs) {
+        if (mad > 0.0 && 0.6745 * std::fabs(sample - median) / mad > outlierCutoff) {
+            stats.outliers++;
+        } else {
+            kept.push_back(sample);
+        }
+    }
+
+    double sum = 0.0;
+    for (double sample : kept) {
+        sum += sample;
+    }
+    double mean = sum / static_cast<double>(kept.size());
+
+    double squares = 0.0;
+    for (double sample : kept) {
+        squares += (sample - mean) * (sample - mean);
+    }
+
+    stats.minMs = kept.front();
+    stats.medianMs = percentile(kept, 0.5);
+    stats.meanMs = mean;
+    stats.p90Ms = percentile(kept, 0.90);
+    stats.p99Ms = percentile(kept, 0.99);
+    stats.stddevMs = kept.size() > 1 ? std::sqrt(squares / static_cast<double>(kept.size() - 1)) : 0.0;
+    stats.samples = static_cast<int>(kept.size());
+    return stats;
+}
+
+void BenchmarkBuffer::prepare(size_t copyCount, size_t count) {
+    if (copies.size() < copyCount) {
+        copies.resize(copyCount);
+    }
+    for (size_t i = 0; i < copyCount; i++) {
+        std::vector<int>& copy = copies[i];
+        // A fresh block rather than a reallocation, which would also copy
+        // the old contents; resizing writes the new elements, which faults
+        // their pages in now instead of in the first run
+        if (copy.capacity() < count) {
+            std::vector<int>().swap(copy);
+        }
+        copy.resize(count);
+    }
+}
+
+void BenchmarkBuffer::reset(size_t i, const int* keys, size_t count) {
+    if (count > 0) {
+        std::memcpy(copies[i].data(), keys, count * sizeof(int));
+    }
+}
+
+void BenchmarkBuffer::prepareReference(const int* keys, size_t count) {
+    sortedReference.assign(keys, keys + count);
+    std::sort(sortedReference.begin(), sortedReference.end());
+}
+
+size_t BenchmarkBuffer::capacityBytes() const {
+    size_t elements = sortedReference.capacity();
+    for (const std::vector<int>& copy : copies) {
+        elements += copy.capacity();
+    }
+    return elements * sizeof(int);
+}
+
+void BenchmarkBuffer::release() {
+    std::vector<std::vector<int>>().swap(copies);
+    std::vector<int>().swap(sortedReference);
+}
+
+// Time one algorithm.sort call on data
+static double timeSort(SortingAlgorithm& algorithm, std::vector<int>& data) {
+    auto start = std::chrono::steady_clock::now();
+    algorithm.sort(data);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+SortingResult runSortingBenchmark(
+    SortingAlgorithm& algorithm,
+    const int* keys,
+    size_t count,
+    const BenchmarkConfig& config,
+    BenchmarkBuffer& buffer
+) {
+    // Create result structure
+    SortingResult result;
+    result.algorithmName = algorithm.getName();
+    result.isStable = algorithm.isStable();
+    result.threads = algorithm.getThreadCount();
+    result.isSorted = true;
+
+    // Every run must reproduce the reference exactly: sorted, and a
+    // permutation of the input
+    if (config.verify) {
+        buffer.prepareReference(keys, count);
+    }
+    auto check = [&](const std::vector<int>& data) {
+        if (config.verify && data != buffer.reference()) {
+            result.isSorted = false;
+        }
+    };
+
+    // Counters are opened up front so they cover the pool threads of the
+    // parallel sorts; without them the counts are reported as missing
+    std::unique_ptr<PerfCounters> counters;
+    if (config.countEvents) {
+        counters = std::make_unique<PerfCounters>();
+    }
+    auto startCounters = [&] { if (counters) counters->start(); };
+    auto stopCounters = [&] { if (counters) counters->stop(); };
+
+    // First warmup run: measures how long one sort takes and its heap use.
+    // Cached scratch memory is dropped first so the sort allocates all of it.
+    // Copy 0 of the buffer is the algorithm's copy of the input; later runs
+    // restore it.
+    buffer.prepare(1, count);
+    std::vector<int>& data = buffer.copy(0);
+    buffer.reset(0, keys, count);
+    double firstRunMs;
+    {
+        ExclusiveSection exclusive(config.concurrent);
+        algorithm.releaseMemory();
+        AllocationScope allocationScope;
+        startCounters();
+        firstRunMs = timeSort(algorithm, data);
+        stopCounters();
+        result.allocations = allocationScope.stats();
+    }
+    result.memoryUsageBytes = result.allocations.peakLiveBytes;
+    check(data);
+
+    std::vector<double> samples;
+    int batch = 1;
+
+    if (firstRunMs >= config.timeBudgetMs) {
+        // Warmup effects are negligible next to a run this long
+        samples.push_back(firstRunMs);
+    } else {
+        if (counters) counters->reset();
+
+        for (int run = 1; run < config.warmupRuns; run++) {
+            buffer.reset(0, keys, count);
+            timeSort(algorithm, data);
+            check(data);
+        }
+
+        // Batch short sorts so one sample is well above the clock's resolution
+        if (firstRunMs < config.minSampleMs && count > 0) {
+            double wanted = std::ceil(config.minSampleMs / std::max(firstRunMs, 1e-6));
+            double fits = static_cast<double>(std::max<size_t>(1, config.batchMaxElements / count));
+            batch = static_cast<int>(std::min(wanted, fits));
+        }
+
+        // The warmup copy is the first of the batch, so an unbatched sort
+        // never has a second copy of the input
+        buffer.prepare(static_cast<size_t>(batch), count);
+        double measuredMs = 0.0;
+
+        for (int sample = 0; sample < config.samples; sample++) {
+            if (sample >= config.minSamples && measuredMs >= config.timeBudgetMs) {
+                break;
+            }
+
+            for (int i = 0; i < batch; i++) {
+                buffer.reset(i, keys, count);
+            }
+
+            startCounters();
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < batch; i++) {
+                algorithm.sort(buffer.copy(i));
+            }
+            auto end = std::chrono::steady_clock::now();
+            stopCounters();
+
+            double elapsedMs = std::chrono::duration<double, std::milli>(end - start).count();
+            measuredMs += elapsedMs;
+            samples.push_back(elapsedMs / batch);
+
+            for (int i = 0; i < batch; i++) {
+                check(buffer.copy(i));
+            }
+        }
+    }
+
+    result.timing = summarizeSamples(samples, config.outlierCutoff);
+    result.timing.sortsPerSample = batch;
+    result.executionTimeMs = result.timing.medianMs;
+    result.dataSize = count;
+    if (counters) {
+        result.counters = counters->read(static_cast<double>(samples.size()) * batch);
+    }
+
+    // The instrumented run is several times slower than a timed one, so it
+    // is skipped for sorts that are already over budget
+    if (config.countOperations && firstRunMs < config.timeBudgetMs) {
+        ExclusiveSection exclusive(config.concurrent);
+        buffer.reset(0, keys, count);
+        result.operations = algorithm.countOperations(buffer.copy(0));
+    }
+    return result;
+}
+
+SortingResult runSortingBenchmark(
+    SortingAlgorithm& algorithm,
+    const int* keys,
+    size_t count,
+    const BenchmarkConfig& config
+) {
+    BenchmarkBuffer buffer;
+    return runSortingBenchmark(algorithm, keys, count, config, buffer);
+}
+
+SortingResult runSortingBenchmark(
+    SortingAlgorithm& algorithm,
+    const std::vector<int>& originalData,
+    const BenchmarkConfig& config
+) {
+    return runSortingBenchmark(algorithm, originalData.data(), originalData.size(), config);
+}
+
+SortingResult runSortingBenchmark(
+    SortingAlgorithm& algorithm,
+    const std::vector<int>& originalData,
+    bool checkSorted
+) {
+    BenchmarkConfig config;
+    config.verify = checkSorted;
+    return runSortingBenchmark(algorithm, originalData, config);
+}
@@ -1,24 +1,13 @@
 #include "../include/sorting.h"
+#include "../include/sort_algorithms.h"
+#include "../include/op_counter.h"
 
 void BubbleSort::sort(std::vector<int>& arr) {
-    int n = arr.size();
-    bool swapped;
-    
-    for (int i = 0; i < n - 1; i++) {
-        swapped = false;
-        
-        // Last i elements are already in place
-        for (int j = 0; j < n - i - 1; j++) {
-            // If the element found is greater than the next element,
-            // swap them and mark swapped as true
-            if (arr[j] > arr[j + 1]) {
-                std::swap(arr[j], arr[j + 1]);
-                swapped = true;
-            }
-        }
-        
-        // If no swapping occurred in this pass, array is sorted
-        if (!swapped)
-            break;
-    }
-}
\ No newline at end of file
+    sorting::bubbleSort(arr.begin(), arr.end(), std::less<int>());
+}
+
+OperationCounts BubbleSort::countOperations(const std::vector<int>& data) {
+    return sorting::countOperations(data, [](auto first, auto last) {
+        sorting::bubbleSort(first, last, std::less<>());
+    });
+}
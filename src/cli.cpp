@@ -0,0 +1,506 @@
+#include "../include/cli.h"
+#include "../include/benchmark.h"
+#include "../include/compare.h"
+#include "../include/dataset_file.h"
+#include "../include/external_sort.h"
+#include "../include/perf_counters.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+// Split a comma-separated option value, dropping empty items
+static std::vector<std::string> splitList(const std::string& value) {
+    std::vector<std::string> items;
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+// Parse a non-negative integer; sizes may also be written like 1e6
+static std::uint64_t parseCount(const std::string& option, const std::string& text) {
+    try {
+        size_t end = 0;
+        if (text.find_first_of("eE") != std::string::npos) {
+            double value = std::stod(text, &end);
+            if (end == text.size() && value >= 0 && value == std::floor(value)) {
+                return static_cast<std::uint64_t>(value);
+            }
+        } else if (!text.empty() && text[0] != '-') {
+            std::uint64_t value = std::stoull(text, &end);
+            if (end == text.size()) {
+                return value;
+            }
+        }
+    } catch (const std::exception&) {
+        // Reported below
+    }
+    throw std::invalid_argument("invalid value '" + text + "' for --" + option);
+}
+
+// Parse a byte count with an optional binary K, M, G or T suffix (e.g. 512M)
+static std::uint64_t parseBytes(const std::string& option, const std::string& text) {
+    static const std::string suffixes = "KMGT";
+    size_t suffix = text.empty() ? std::string::npos : suffixes.find(static_cast<char>(std::toupper(
+                                                           static_cast<unsigned char>(text.back()))));
+    if (suffix == std::string::npos) {
+        return parseCount(option, text);
+    }
+    std::uint64_t value = parseCount(option, text.substr(0, text.size() - 1));
+    int shift = 10 * static_cast<int>(suffix + 1);
+    if (value > (UINT64_MAX >> shift)) {
+        throw std::invalid_argument("invalid value '" + text + "' for --" + option);
+    }
+    return value << shift;
+}
+
+static DataSetType parseDistribution(const std::string& key) {
+    for (DataSetType type : allDataSetTypes()) {
+        if (dataSetKey(type) == key) {
+            return type;
+        }
+    }
+    throw std::invalid_argument("unknown distribution '" + key + "'");
+}
+
+std::string algorithmKey(const std::string& name) {
+    std::string key;
+    for (char c : name) {
+        if (std::isalnum(static_cast<unsigned char>(c))) {
+            key += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        } else if (!key.empty() && key.back() != '-') {
+            key += '-';
+        }
+    }
+    while (!key.empty() && key.back() == '-') {
+        key.pop_back();
+    }
+
+    const std::string suffix = "-sort";
+    if (key.size() > suffix.size() && key.compare(key.size() - suffix.size(), suffix.size(), suffix) == 0) {
+        key.erase(key.size() - suffix.size());
+    }
+    return key;
+}
+
+BenchmarkOptions parseCommandLine(int argc, char* argv[]) {
+    BenchmarkOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            options.showHelp = true;
+            continue;
+        }
+        if (arg == "--append") {
+            options.append = true;
+            continue;
+        }
+
+        size_t equals = arg.find('=');
+        if (arg.compare(0, 2, "--") != 0 || equals == std::string::npos) {
+            throw std::invalid_argument("unrecognized argument '" + arg + "'");
+        }
+
+        std::string name = arg.substr(2, equals - 2);
+        std::string value = arg.substr(equals + 1);
+
+        if (name == "algorithms") {
+            options.algorithms.clear();
+            for (const std::string& item : splitList(value)) {
+                options.algorithms.push_back(algorithmKey(item));
+            }
+        } else if (name == "sizes") {
+            options.sizes.clear();
+            for (const std::string& item : splitList(value)) {
+                options.sizes.push_back(static_cast<size_t>(parseCount(name, item)));
+            }
+            if (options.sizes.empty()) {
+                throw std::invalid_argument("--sizes needs at least one size");
+            }
+            options.sizesGiven = true;
+        } else if (name == "distributions") {
+            options.distributions.clear();
+            for (const std::string& item : splitList(value)) {
+                if (item == "all") {
+                    options.distributions = allDataSetTypes();
+                    break;
+                }
+                options.distributions.push_back(parseDistribution(item));
+            }
+            if (options.distributions.empty()) {
+                throw std::invalid_argument("--distributions needs at least one distribution");
+            }
+            options.distributionsGiven = true;
+        } else if (name == "data-files") {
+            for (const std::string& item : splitList(value)) {
+                options.dataSetFiles.push_back(item);
+            }
+            if (options.dataSetFiles.empty()) {
+                throw std::invalid_argument("--data-files needs at least one file");
+            }
+        } else if (name == "write-data") {
+            if (value.empty()) {
+                throw std::invalid_argument("--write-data needs a directory");
+            }
+            options.writeDataDirectory = value;
+        } else if (name == "run-length") {
+            std::uint64_t runLength = parseCount(name, value);
+            if (runLength < 1) {
+                throw std::invalid_argument("--run-length must be at least 1");
+            }
+            options.dataSetParams.runLength = static_cast<size_t>(runLength);
+        } else if (name == "jobs") {
+            options.jobs = static_cast<size_t>(parseCount(name, value));
+        } else if (name == "pin") {
+            if (value == "none") {
+                options.pin = PinMode::NONE;
+            } else if (value == "cpu") {
+                options.pin = PinMode::CPU;
+            } else if (value == "core") {
+                options.pin = PinMode::CORE;
+            } else {
+                throw std::invalid_argument("--pin must be none, cpu or core");
+            }
+        } else if (name == "cell-timeout") {
+            options.cellTimeoutSeconds = static_cast<double>(parseCount(name, value));
+        } else if (name == "max-quadratic-size") {
+            options.maxQuadraticSize = static_cast<size_t>(parseCount(name, value));
+        } else if (name == "repeats") {
+            std::uint64_t repeats = parseCount(name, value);
+            if (repeats < 1 || repeats > 1000000) {
+                throw std::invalid_argument("--repeats must be between 1 and 1000000");
+            }
+            options.repeats = static_cast<int>(repeats);
+        } else if (name == "warmup") {
+            std::uint64_t warmup = parseCount(name, value);
+            if (warmup < 1 || warmup > 1000) {
+                throw std::invalid_argument("--warmup must be between 1 and 1000");
+            }
+            options.warmupRuns = static_cast<int>(warmup);
+        } else if (name == "threads") {
+            options.threadCount = static_cast<size_t>(parseCount(name, value));
+        } else if (name == "seed") {
+            options.seed = parseCount(name, value);
+            options.hasSeed = true;
+        } else if (name == "output") {
+            options.output = value;
+        } else if (name == "format") {
+            if (value == "csv") {
+                options.format = OutputFormat::CSV;
+            } else if (value == "json") {
+                options.format = OutputFormat::JSON;
+            } else if (value == "jsonl") {
+                options.format = OutputFormat::JSON_LINES;
+            } else {
+                throw std::invalid_argument("--format must be csv, json or jsonl");
+            }
+        } else if (name == "compare") {
+            std::vector<std::string> files = splitList(value);
+            if (files.size() != 2) {
+                throw std::invalid_argument("--compare needs two files, BASELINE,CANDIDATE");
+            }
+            options.compareBaseline = files[0];
+            options.compareCandidate = files[1];
+        } else if (name == "external-sort") {
+            std::vector<std::string> files = splitList(value);
+            if (files.size() != 2) {
+                throw std::invalid_argument("--external-sort needs two files, INPUT,OUTPUT");
+            }
+            options.externalInput = files[0];
+            options.externalOutput = files[1];
+        } else if (name == "memory") {
+            options.memoryBudget = static_cast<size_t>(parseBytes(name, value));
+        } else if (name == "temp-dir") {
+            options.tempDirectory = value;
+        } else if (name == "threshold") {
+            size_t end = 0;
+            try {
+                options.thresholdPercent = std::stod(value, &end);
+            } catch (const std::exception&) {
+                end = 0;
+            }
+            if (end == 0 || end != value.size() || options.thresholdPercent < 0.0) {
+                throw std::invalid_argument("invalid value '" + value + "' for --threshold");
+            }
+        } else {
+            throw std::invalid_argument("unknown option --" + name);
+        }
+    }
+
+    if (!options.dataSetFiles.empty() && (options.sizesGiven || options.distributionsGiven)) {
+        throw std::invalid_argument("--data-files replaces --sizes and --distributions");
+    }
+    if (!options.dataSetFiles.empty() && !options.writeDataDirectory.empty()) {
+        throw std::invalid_argument("--data-files and --write-data cannot be combined");
+    }
+    if (options.append && options.format == OutputFormat::JSON) {
+        throw std::invalid_argument("--append needs --format=csv or jsonl");
+    }
+    return options;
+}
+
+void printUsage(std::ostream& out, const std::string& program) {
+    out << "Usage: " << program << " [--option=value ...]\n"
+        << "Without arguments the interactive menu starts.\n\n"
+        << "Options:\n"
+        << "  --algorithms=LIST     comma-separated algorithm keys, or all (default)\n"
+        << "                        e.g. merge,quick,lsd-radix,parallel-merge\n"
+        << "  --sizes=LIST          comma-separated element counts (default 1000,10000,100000,1000000)\n"
+        << "  --distributions=LIST  comma-separated data sets, or all (default):\n"
+        << "                       ";
+    const std::vector<DataSetType>& types = allDataSetTypes();
+    for (size_t i = 0; i < types.size(); i++) {
+        if (i > 0 && i % 5 == 0) {
+            out << "\n                       ";
+        }
+        out << " " << dataSetKey(types[i]);
+    }
+    out << "\n"
+        << "  --data-files=LIST     run on binary data set files instead of generated data;\n"
+        << "                        may be given more than once\n"
+        << "  --write-data=DIR      write the data sets of --sizes and --distributions to DIR as\n"
+        << "                        binary data set files instead of running\n"
+        << "  --run-length=N        run length of runs and period of sawtooth (default 1000)\n"
+        << "  --repeats=N           timed samples per cell (default 10)\n"
+        << "  --warmup=N            untimed runs before sampling (default 1)\n"
+        << "  --threads=N           threads of the parallel algorithms, 0 = all cores (default 0)\n"
+        << "  --jobs=N              cells of single-threaded algorithms run at once, 0 = one per\n"
+        << "                        usable CPU, or physical core with --pin=core (default 1)\n"
+        << "  --pin=none|cpu|core   pin each job to its own logical CPU, or to its own physical\n"
+        << "                        core leaving SMT siblings idle (default none)\n"
+        << "  --cell-timeout=S      skip cells where one sort is predicted, from the algorithm's\n"
+        << "                        previous size, to take longer than S seconds, 0 = never (default 0)\n"
+        << "  --max-quadratic-size=N  skip O(n^2) algorithms above N elements, 0 = never (default 100000)\n"
+        << "  --seed=N              base seed of the data sets (default: random, printed)\n"
+        << "  --output=FILE         result file, - for standard output (default)\n"
+        << "  --format=csv|json|jsonl  result format (default csv); jsonl writes one object per\n"
+        << "                        line with the host, compiler and git metadata\n"
+        << "  --append              append to the output file instead of replacing it (csv, jsonl)\n"
+        << "  --compare=BASE,NEW    compare two result files (csv, json or jsonl) instead of running;\n"
+        << "                        --algorithms, --sizes and --distributions select the cells\n"
+        << "  --threshold=PERCENT   slowdown that fails --compare, if its 95% interval excludes\n"
+        << "                        no change (default 5)\n"
+        << "  --external-sort=IN,OUT  sort a file of native 32-bit keys that may not fit in RAM,\n"
+        << "                        with the algorithm of --algorithms (default pdq)\n"
+        << "  --memory=BYTES        memory budget of --external-sort, suffix K, M or G (default 1G)\n"
+        << "  --temp-dir=DIR        where --external-sort spills runs (default: next to OUT)\n"
+        << "  --help                show this message\n";
+}
+
+int runCommandLine(const BenchmarkOptions& options, const AlgorithmFactory& factory) {
+    // Resolve the algorithm keys against the registry
+    std::vector<std::unique_ptr<SortingAlgorithm>> algorithms = factory(1);
+    MatrixOptions matrix;
+    bool selectAll = options.algorithms.empty() ||
+                     std::find(options.algorithms.begin(), options.algorithms.end(), "all") != options.algorithms.end();
+    if (!selectAll) {
+        for (const std::string& key : options.algorithms) {
+            auto match = std::find_if(algorithms.begin(), algorithms.end(), [&](const auto& algorithm) {
+                return algorithmKey(algorithm->getName()) == key;
+            });
+            if (match == algorithms.end()) {
+                std::cerr << "Error: unknown algorithm '" << key << "'. Available:";
+                for (const auto& algorithm : algorithms) {
+                    std::cerr << " " << algorithmKey(algorithm->getName());
+                }
+                std::cerr << std::endl;
+                return 2;
+            }
+            matrix.algorithms.push_back(static_cast<size_t>(match - algorithms.begin()));
+        }
+    }
+
+    // Bad data set files are reported before anything runs
+    for (const std::string& path : options.dataSetFiles) {
+        try {
+            readDataSetFileInfo(path);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 2;
+        }
+    }
+
+    matrix.seed = options.hasSeed ? options.seed : randomSeed();
+    if (options.dataSetFiles.empty()) {
+        std::cerr << "Seed: " << matrix.seed << std::endl;
+    }
+
+    PerfCounters probe;
+    if (!probe.available()) {
+        std::cerr << "Hardware counters unavailable (" << probe.unavailableReason() << "); "
+                  << "counter columns will be empty" << std::endl;
+    } else if (options.jobs != 1) {
+        std::cerr << "Hardware counters are only read with --jobs=1" << std::endl;
+    }
+
+    matrix.sizes = options.sizes;
+    matrix.distributions = options.distributions;
+    matrix.dataSetParams = options.dataSetParams;
+    matrix.dataSetFiles = options.dataSetFiles;
+    matrix.threadCount = options.threadCount;
+    matrix.config.samples = options.repeats;
+    matrix.config.warmupRuns = options.warmupRuns;
+    matrix.jobs = options.jobs;
+    matrix.pinThreads = options.pin != PinMode::NONE;
+    matrix.physicalCoresOnly = options.pin == PinMode::CORE;
+    matrix.cellTimeoutMs = options.cellTimeoutSeconds * 1000.0;
+    matrix.maxQuadraticSize = options.maxQuadraticSize;
+
+    RunMetadata metadata = collectRunMetadata();
+    std::vector<SortingResult> results = runBenchmarkMatrix(matrix, factory, std::cerr);
+
+    bool allSorted = true;
+    for (const SortingResult& result : results) {
+        if (!result.isSorted) {
+            std::cerr << "  " << resultLabel(result) << " did not sort the data!" << std::endl;
+            allSorted = false;
+        }
+    }
+
+    std::ofstream file;
+    bool toStdout = options.output.empty() || options.output == "-";
+    bool header = true;
+    if (!toStdout) {
+        // Appending to a file that already has rows leaves out the CSV header
+        if (options.append) {
+            std::ifstream existing(options.output, std::ios::binary | std::ios::ate);
+            header = !existing.is_open() || existing.tellg() <= 0;
+        }
+        file.open(options.output, options.append ? std::ios::app : std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not open file " << options.output << " for writing." << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = toStdout ? std::cout : file;
+
+    if (options.format == OutputFormat::JSON) {
+        writeResultsJSON(out, results);
+    } else if (options.format == OutputFormat::JSON_LINES) {
+        writeResultsJSONLines(out, results, metadata);
+    } else {
+        writeResultsCSV(out, results, header);
+    }
+
+    if (!toStdout) {
+        std::cerr << "Results saved to " << options.output << std::endl;
+    }
+
+    // A sort that produced unsorted output fails the run
+    return allSorted ? 0 : 1;
+}
+
+int writeDataSets(const BenchmarkOptions& options) {
+    std::uint64_t seed = options.hasSeed ? options.seed : randomSeed();
+    std::cerr << "Seed: " << seed << std::endl;
+
+    for (size_t size : options.sizes) {
+        for (DataSetType type : options.distributions) {
+            DataSetFileInfo info;
+            info.seed = dataSetSeed(seed, size, type);
+            info.hasSeed = true;
+            info.distribution = dataSetKey(type);
+            std::string path = options.writeDataDirectory + "/" + dataSetKey(type) + "-" + std::to_string(size) + ".keys";
+            try {
+                saveDataSetFile(path, generateDataSet(type, size, info.seed, options.dataSetParams), info);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return 2;
+            }
+            std::cerr << "Wrote " << path << std::endl;
+        }
+    }
+    return 0;
+}
+
+int runComparison(const BenchmarkOptions& options) {
+    std::vector<ResultRow> baseline;
+    std::vector<ResultRow> candidate;
+    try {
+        baseline = loadResultRows(options.compareBaseline);
+        candidate = loadResultRows(options.compareCandidate);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 2;
+    }
+
+    CompareFilter filter;
+    if (std::find(options.algorithms.begin(), options.algorithms.end(), "all") == options.algorithms.end()) {
+        filter.algorithms = options.algorithms;
+    }
+    if (options.sizesGiven) {
+        filter.sizes = options.sizes;
+    }
+    if (options.distributionsGiven) {
+        for (DataSetType type : options.distributions) {
+            filter.distributions.push_back(dataSetName(type));
+        }
+    }
+
+    std::vector<Comparison> comparisons = compareResults(baseline, candidate, filter, options.thresholdPercent);
+    printComparison(std::cout, comparisons, options.thresholdPercent);
+
+    // Without a selection, cells of only one file are worth knowing about
+    bool filtered = !filter.algorithms.empty() || !filter.sizes.empty() || !filter.distributions.empty();
+    if (!filtered && (baseline.size() > comparisons.size() || candidate.size() > comparisons.size())) {
+        std::cout << baseline.size() - comparisons.size() << " cells only in " << options.compareBaseline << ", "
+                  << candidate.size() - comparisons.size() << " only in " << options.compareCandidate << std::endl;
+    }
+
+    if (comparisons.empty()) {
+        std::cerr << "Error: the files have no cells in common" << std::endl;
+        return 2;
+    }
+    bool regressed = std::any_of(comparisons.begin(), comparisons.end(), [](const Comparison& comparison) {
+        return comparison.regression;
+    });
+    return regressed ? 1 : 0;
+}
+
+int runExternalSort(const BenchmarkOptions& options, const AlgorithmFactory& factory) {
+    std::vector<std::unique_ptr<SortingAlgorithm>> algorithms = factory(options.threadCount);
+    std::string key = options.algorithms.empty() ? "pdq" : options.algorithms.front();
+    if (options.algorithms.size() > 1 || key == "all") {
+        std::cerr << "Error: --external-sort takes a single algorithm" << std::endl;
+        return 2;
+    }
+    auto match = std::find_if(algorithms.begin(), algorithms.end(), [&](const auto& algorithm) {
+        return algorithmKey(algorithm->getName()) == key;
+    });
+    if (match == algorithms.end()) {
+        std::cerr << "Error: unknown algorithm '" << key << "'" << std::endl;
+        return 2;
+    }
+
+    ExternalSortOptions sortOptions;
+    sortOptions.memoryBudget = options.memoryBudget;
+    sortOptions.tempDirectory = options.tempDirectory;
+
+    ExternalSortStats stats;
+    try {
+        stats = externalSort(options.externalInput, options.externalOutput, **match, sortOptions);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 2;
+    }
+
+    std::cerr << "Sorted " << stats.elements << " keys with " << (*match)->getName() << ": "
+              << stats.runs << " runs of up to " << stats.chunkElements << " keys in "
+              << std::fixed << std::setprecision(1) << stats.runFormationMs << " ms";
+    if (stats.mergePasses > 0) {
+        std::cerr << ", " << stats.mergePasses << " merge passes of up to " << stats.fanIn << " runs with "
+                  << (stats.bufferBytes >> 10) << " KiB buffers in " << stats.mergeMs << " ms";
+    }
+    std::cerr << std::endl;
+    return 0;
+}
@@ -0,0 +1,476 @@
+#include "../include/compare.h"
+#include "../include/cli.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+static std::string lowerCase(const std::string& text) {
+    std::string lower = text;
+    for (char& c : lower) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return lower;
+}
+
+static std::string trim(const std::string& text) {
+    size_t start = text.find_first_not_of(" \t\r");
+    if (start == std::string::npos) {
+        return "";
+    }
+    return text.substr(start, text.find_last_not_of(" \t\r") - start + 1);
+}
+
+// Split a CSV record; quoted fields may hold separators and doubled quotes
+static std::vector<std::string> splitCSV(const std::string& line) {
+    std::vector<std::string> fields(1);
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); i++) {
+        char c = line[i];
+        if (quoted) {
+            if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+                fields.back() += '"';
+                i++;
+            } else if (c == '"') {
+                quoted = false;
+            } else {
+                fields.back() += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.emplace_back();
+        } else if (c != '\r') {
+            fields.back() += c;
+        }
+    }
+    return fields;
+}
+
+// Unpack a "Name [Distribution, n=N]" label (resultLabel) into the row
+static void parseLabel(const std::string& label, ResultRow& row) {
+    row.algorithm = trim(label);
+    size_t open = label.rfind(" [");
+    size_t comma = label.rfind(", n=");
+    if (open == std::string::npos || comma == std::string::npos || comma < open || label.back() != ']') {
+        return;
+    }
+    std::string size = label.substr(comma + 4, label.size() - comma - 5);
+    if (size.empty() || size.find_first_not_of("0123456789") != std::string::npos) {
+        return;
+    }
+    row.algorithm = trim(label.substr(0, open));
+    row.distribution = label.substr(open + 2, comma - open - 2);
+    row.n = static_cast<size_t>(std::stoull(size));
+}
+
+static double parseNumber(const std::string& text, const std::string& path) {
+    try {
+        size_t end = 0;
+        double value = std::stod(text, &end);
+        if (trim(text.substr(end)).empty()) {
+            return value;
+        }
+    } catch (const std::exception&) {
+        // Reported below
+    }
+    throw std::runtime_error(path + ": invalid number '" + text + "'");
+}
+
+// The CSV of writeResultsCSV, or the older one with only the label, time,
+// memory, stable and sorted columns
+static std::vector<ResultRow> parseCSV(std::istream& in, const std::string& path) {
+    std::string line;
+    if (!std::getline(in, line)) {
+        throw std::runtime_error(path + ": empty file");
+    }
+    std::vector<std::string> header = splitCSV(line);
+    auto column = [&](const std::string& name) {
+        auto found = std::find(header.begin(), header.end(), name);
+        return found == header.end() ? -1 : static_cast<int>(found - header.begin());
+    };
+    int algorithmColumn = column("Algorithm");
+    int timeColumn = column("Time (ms)");
+    if (algorithmColumn < 0 || timeColumn < 0) {
+        throw std::runtime_error(path + ": not a result file (no Algorithm and Time (ms) columns)");
+    }
+    int distributionColumn = column("Distribution");
+    int sizeColumn = column("N");
+    int stddevColumn = column("Stddev (ms)");
+    int samplesColumn = column("Samples");
+
+    std::vector<ResultRow> rows;
+    while (std::getline(in, line)) {
+        if (trim(line).empty()) {
+            continue;
+        }
+        // A repeated header, left by appending to a file written without one
+        if (line.compare(0, 10, "Algorithm,") == 0) {
+            continue;
+        }
+        std::vector<std::string> fields = splitCSV(line);
+
+        // The older writer did not quote its labels, so their ", n=N]" part
+        // spilled into a field of its own
+        if (fields.size() == header.size() + 1 && algorithmColumn + 1 < static_cast<int>(fields.size())) {
+            fields[algorithmColumn] += "," + fields[algorithmColumn + 1];
+            fields.erase(fields.begin() + algorithmColumn + 1);
+        }
+        if (fields.size() < header.size()) {
+            throw std::runtime_error(path + ": short row '" + line + "'");
+        }
+
+        ResultRow row;
+        if (distributionColumn >= 0 && sizeColumn >= 0) {
+            row.algorithm = trim(fields[algorithmColumn]);
+            row.distribution = fields[distributionColumn];
+            if (!fields[sizeColumn].empty()) {
+                row.n = static_cast<size_t>(parseNumber(fields[sizeColumn], path));
+            }
+        } else {
+            parseLabel(fields[algorithmColumn], row);
+        }
+        row.medianMs = parseNumber(fields[timeColumn], path);
+        if (stddevColumn >= 0 && !fields[stddevColumn].empty()) {
+            row.stddevMs = parseNumber(fields[stddevColumn], path);
+        }
+        if (samplesColumn >= 0 && !fields[samplesColumn].empty()) {
+            row.samples = static_cast<int>(parseNumber(fields[samplesColumn], path));
+        }
+        rows.push_back(row);
+    }
+    return rows;
+}
+
+namespace {
+
+// Reads the flat objects of a JSON array or of JSON Lines; nested values
+// are not used by the result files and are rejected
+class JsonReader {
+public:
+    JsonReader(const std::string& text, const std::string& path) : text_(text), path_(path) {}
+
+    // The members of every top-level object, values as their text
+    std::vector<std::map<std::string, std::string>> objects() {
+        std::vector<std::map<std::string, std::string>> result;
+        while (skipSpace()) {
+            char c = text_[pos_];
+            if (c == '[' || c == ']' || c == ',') {
+                pos_++;
+            } else if (c == '{') {
+                result.push_back(object());
+            } else {
+                fail("unexpected '" + std::string(1, c) + "'");
+            }
+        }
+        return result;
+    }
+
+private:
+    const std::string& text_;
+    const std::string& path_;
+    size_t pos_ = 0;
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw std::runtime_error(path_ + ": invalid JSON at offset " + std::to_string(pos_) + ": " + message);
+    }
+
+    // Skip white space; false at the end of the text
+    bool skipSpace() {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+            pos_++;
+        }
+        return pos_ < text_.size();
+    }
+
+    void expect(char c) {
+        if (!skipSpace() || text_[pos_] != c) {
+            fail(std::string("expected '") + c + "'");
+        }
+        pos_++;
+    }
+
+    std::string string() {
+        expect('"');
+        std::string value;
+        while (pos_ < text_.size() && text_[pos_] != '"') {
+            char c = text_[pos_++];
+            if (c == '\\' && pos_ < text_.size()) {
+                char escaped = text_[pos_++];
+                switch (escaped) {
+                    case 'n': value += '\n'; break;
+                    case 't': value += '\t'; break;
+                    case 'r': value += '\r'; break;
+                    case 'u':
+                        // Only control characters are written escaped
+                        if (pos_ + 4 > text_.size()) {
+                            fail("truncated escape");
+                        }
+                        value += static_cast<char>(std::stoi(text_.substr(pos_, 4), nullptr, 16));
+                        pos_ += 4;
+                        break;
+                    default: value += escaped;
+                }
+            } else {
+                value += c;
+            }
+        }
+        if (pos_ >= text_.size()) {
+            fail("unterminated string");
+        }
+        pos_++;
+        return value;
+    }
+
+    std::map<std::string, std::string> object() {
+        std::map<std::string, std::string> members;
+        expect('{');
+        if (skipSpace() && text_[pos_] == '}') {
+            pos_++;
+            return members;
+        }
+        while (true) {
+            std::string key = string();
+            expect(':');
+            if (!skipSpace()) {
+                fail("missing value");
+            }
+            if (text_[pos_] == '"') {
+                members[key] = string();
+            } else if (text_[pos_] == '{' || text_[pos_] == '[') {
+                fail("nested value of '" + key + "'");
+            } else {
+                size_t end = text_.find_first_of(",}", pos_);
+                if (end == std::string::npos) {
+                    fail("unterminated object");
+                }
+                members[key] = trim(text_.substr(pos_, end - pos_));
+                pos_ = end;
+            }
+            if (!skipSpace()) {
+                fail("unterminated object");
+            }
+            if (text_[pos_] == '}') {
+                pos_++;
+                return members;
+            }
+            expect(',');
+        }
+    }
+};
+
+} // namespace
+
+// Objects written by writeResultsJSON or writeResultsJSONLines
+static std::vector<ResultRow> parseJSON(const std::string& text, const std::string& path) {
+    std::vector<ResultRow> rows;
+    for (const auto& members : JsonReader(text, path).objects()) {
+        auto value = [&](const std::string& key) {
+            auto found = members.find(key);
+            return found == members.end() || found->second == "null" ? std::string() : found->second;
+        };
+        ResultRow row;
+        row.algorithm = value("algorithm");
+        row.distribution = value("distribution");
+        if (row.algorithm.empty() || value("timeMs").empty()) {
+            throw std::runtime_error(path + ": result without algorithm or timeMs");
+        }
+        if (!value("n").empty()) {
+            row.n = static_cast<size_t>(parseNumber(value("n"), path));
+        }
+        row.medianMs = parseNumber(value("timeMs"), path);
+        if (!value("stddevMs").empty()) {
+            row.stddevMs = parseNumber(value("stddevMs"), path);
+        }
+        if (!value("samples").empty()) {
+            row.samples = static_cast<int>(parseNumber(value("samples"), path));
+        }
+        rows.push_back(row);
+    }
+    return rows;
+}
+
+// Key a row is matched by
+static std::tuple<std::string, std::string, size_t> rowKey(const ResultRow& row) {
+    return std::make_tuple(algorithmKey(row.algorithm), lowerCase(row.distribution), row.n);
+}
+
+std::vector<ResultRow> loadResultRows(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("could not open " + path);
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+
+    size_t first = text.find_first_not_of(" \t\r\n");
+    std::vector<ResultRow> parsed;
+    if (first != std::string::npos && (text[first] == '[' || text[first] == '{')) {
+        parsed = parseJSON(text, path);
+    } else {
+        std::istringstream in(text);
+        parsed = parseCSV(in, path);
+    }
+
+    // The last row of a cell wins, in the position of the first
+    std::vector<ResultRow> rows;
+    std::map<std::tuple<std::string, std::string, size_t>, size_t> index;
+    for (const ResultRow& row : parsed) {
+        auto inserted = index.emplace(rowKey(row), rows.size());
+        if (inserted.second) {
+            rows.push_back(row);
+        } else {
+            rows[inserted.first->second] = row;
+        }
+    }
+    return rows;
+}
+
+// Two-sided 95% quantile of Student's t distribution
+static double tQuantile95(double df) {
+    static const double table[] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    if (df < 1.0) {
+        return table[0];
+    }
+    if (df <= 30.0) {
+        return table[static_cast<size_t>(df) - 1];
+    }
+    if (df <= 60.0) {
+        return 2.000;
+    }
+    if (df <= 120.0) {
+        return 1.980;
+    }
+    return 1.960;
+}
+
+// Squared relative standard error of a median, or -1 without statistics
+static double relativeVariance(const ResultRow& row) {
+    if (row.samples < 2 || row.stddevMs < 0.0 || row.medianMs <= 0.0) {
+        return -1.0;
+    }
+    // The median of a normal sample varies sqrt(pi / 2) times as much as
+    // its mean
+    double se = 1.2533 * row.stddevMs / std::sqrt(static_cast<double>(row.samples)) / row.medianMs;
+    return se * se;
+}
+
+std::vector<Comparison> compareResults(
+    const std::vector<ResultRow>& baseline,
+    const std::vector<ResultRow>& candidate,
+    const CompareFilter& filter,
+    double thresholdPercent
+) {
+    std::map<std::tuple<std::string, std::string, size_t>, const ResultRow*> candidates;
+    for (const ResultRow& row : candidate) {
+        candidates[rowKey(row)] = &row;
+    }
+
+    auto selected = [&](const ResultRow& row) {
+        if (!filter.algorithms.empty() &&
+            std::find(filter.algorithms.begin(), filter.algorithms.end(), algorithmKey(row.algorithm)) ==
+                filter.algorithms.end()) {
+            return false;
+        }
+        if (!filter.distributions.empty() &&
+            std::none_of(filter.distributions.begin(), filter.distributions.end(), [&](const std::string& name) {
+                return lowerCase(name) == lowerCase(row.distribution);
+            })) {
+            return false;
+        }
+        return filter.sizes.empty() ||
+               std::find(filter.sizes.begin(), filter.sizes.end(), row.n) != filter.sizes.end();
+    };
+
+    std::vector<Comparison> comparisons;
+    for (const ResultRow& row : baseline) {
+        auto match = candidates.find(rowKey(row));
+        if (match == candidates.end() || !selected(row) || row.medianMs <= 0.0) {
+            continue;
+        }
+
+        Comparison comparison;
+        comparison.baseline = row;
+        comparison.candidate = *match->second;
+        comparison.ratio = comparison.candidate.medianMs / row.medianMs;
+        comparison.lowRatio = comparison.highRatio = comparison.ratio;
+
+        double baseVariance = relativeVariance(comparison.baseline);
+        double candidateVariance = relativeVariance(comparison.candidate);
+        if (baseVariance >= 0.0 && candidateVariance >= 0.0 && comparison.ratio > 0.0) {
+            // Welch-Satterthwaite degrees of freedom
+            double total = baseVariance + candidateVariance;
+            double df = 1e9;
+            double denominator = baseVariance * baseVariance / (comparison.baseline.samples - 1) +
+                                 candidateVariance * candidateVariance / (comparison.candidate.samples - 1);
+            if (denominator > 0.0) {
+                df = total * total / denominator;
+            }
+            double margin = tQuantile95(df) * std::sqrt(total);
+            comparison.lowRatio = comparison.ratio * std::exp(-margin);
+            comparison.highRatio = comparison.ratio * std::exp(margin);
+            comparison.hasInterval = true;
+        }
+
+        comparison.regression = comparison.ratio > 1.0 + thresholdPercent / 100.0 &&
+                                (!comparison.hasInterval || comparison.lowRatio > 1.0);
+        comparisons.push_back(comparison);
+    }
+    return comparisons;
+}
+
+static std::string percentChange(double ratio) {
+    std::ostringstream text;
+    text << std::showpos << std::fixed << std::setprecision(1) << (ratio - 1.0) * 100.0 << "%";
+    return text.str();
+}
+
+void printComparison(std::ostream& out, const std::vector<Comparison>& comparisons, double thresholdPercent) {
+    out << std::left << std::setw(22) << "Algorithm"
+        << std::setw(18) << "Distribution"
+        << std::setw(10) << "n"
+        << std::setw(14) << "Baseline ms"
+        << std::setw(14) << "Candidate ms"
+        << std::setw(10) << "Change"
+        << std::setw(20) << "95% CI" << std::endl;
+    out << std::string(108, '-') << std::endl;
+
+    size_t regressions = 0;
+    size_t improvements = 0;
+    for (const Comparison& comparison : comparisons) {
+        std::string interval = "-";
+        if (comparison.hasInterval) {
+            interval = "[" + percentChange(comparison.lowRatio) + ", " + percentChange(comparison.highRatio) + "]";
+        }
+        out << std::left << std::setw(22) << comparison.baseline.algorithm
+            << std::setw(18) << (comparison.baseline.distribution.empty() ? "-" : comparison.baseline.distribution)
+            << std::setw(10) << (comparison.baseline.n > 0 ? std::to_string(comparison.baseline.n) : "-")
+            << std::fixed << std::setprecision(4)
+            << std::setw(14) << comparison.baseline.medianMs
+            << std::setw(14) << comparison.candidate.medianMs
+            << std::setw(10) << percentChange(comparison.ratio)
+            << std::setw(20) << interval
+            << (comparison.regression ? "REGRESSION" : "") << std::endl;
+
+        if (comparison.regression) {
+            regressions++;
+        } else if (comparison.ratio < 1.0 - thresholdPercent / 100.0 &&
+                   (!comparison.hasInterval || comparison.highRatio < 1.0)) {
+            improvements++;
+        }
+    }
+
+    out << "\n" << comparisons.size() << " cells compared, " << regressions << " slower and "
+        << improvements << " faster by more than " << std::fixed << std::setprecision(1)
+        << thresholdPercent << "%" << std::endl;
+}
@@ -0,0 +1,204 @@
+#include "../include/dataset_file.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SORTING_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(int) == 4, "data set files hold 32-bit keys as int");
+
+namespace {
+
+constexpr char MAGIC[8] = {'S', 'O', 'R', 'T', 'D', 'A', 'T', 'A'};
+constexpr std::uint32_t VERSION = 1;
+constexpr std::uint32_t FLAG_HAS_SEED = 1;
+constexpr size_t HEADER_BYTES = 64;
+constexpr size_t DISTRIBUTION_OFFSET = 40;
+constexpr size_t DISTRIBUTION_BYTES = HEADER_BYTES - DISTRIBUTION_OFFSET;
+
+using File = std::unique_ptr<std::FILE, int (*)(std::FILE*)>;
+
+template <typename T>
+void put(unsigned char* header, size_t offset, T value) {
+    std::memcpy(header + offset, &value, sizeof(value));
+}
+
+template <typename T>
+T get(const unsigned char* header, size_t offset) {
+    T value;
+    std::memcpy(&value, header + offset, sizeof(value));
+    return value;
+}
+
+std::uint32_t byteSwap(std::uint32_t x) {
+    return (x >> 24) | ((x >> 8) & 0xFF00) | ((x << 8) & 0xFF0000) | (x << 24);
+}
+
+// Decode a header and check it against the size of the file
+DataSetFileInfo parseHeader(const unsigned char* header, std::uint64_t fileBytes, const std::string& path) {
+    if (fileBytes < HEADER_BYTES || std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error(path + " is not a data set file");
+    }
+
+    std::uint32_t version = get<std::uint32_t>(header, 8);
+    if (version != VERSION) {
+        if (byteSwap(version) == VERSION) {
+            throw std::runtime_error(path + " was written on a machine of the other byte order");
+        }
+        throw std::runtime_error(path + " has unsupported format version " + std::to_string(version));
+    }
+
+    DataSetFileInfo info;
+    std::uint32_t elementType = get<std::uint32_t>(header, 12);
+    if (elementType != static_cast<std::uint32_t>(DataSetElementType::INT32)) {
+        throw std::runtime_error(path + " has unsupported element type " + std::to_string(elementType));
+    }
+    info.elementType = DataSetElementType::INT32;
+    info.count = get<std::uint64_t>(header, 16);
+    info.seed = get<std::uint64_t>(header, 24);
+    info.hasSeed = (get<std::uint32_t>(header, 32) & FLAG_HAS_SEED) != 0;
+
+    const char* distribution = reinterpret_cast<const char*>(header + DISTRIBUTION_OFFSET);
+    size_t length = 0;
+    while (length < DISTRIBUTION_BYTES && distribution[length] != '\0') {
+        length++;
+    }
+    info.distribution.assign(distribution, length);
+
+    if (info.count > (fileBytes - HEADER_BYTES) / sizeof(int) ||
+        fileBytes - HEADER_BYTES != info.count * sizeof(int)) {
+        throw std::runtime_error(path + " holds " + std::to_string((fileBytes - HEADER_BYTES) / sizeof(int)) +
+                                 " keys, its header says " + std::to_string(info.count));
+    }
+    return info;
+}
+
+File openFile(const std::string& path, const char* mode) {
+    std::FILE* file = std::fopen(path.c_str(), mode);
+    if (!file) {
+        throw std::runtime_error("could not open " + path + ": " + std::strerror(errno));
+    }
+    return File(file, std::fclose);
+}
+
+// Size of an open file, leaving its position at the start
+std::uint64_t fileSize(std::FILE* file, const std::string& path) {
+    if (std::fseek(file, 0, SEEK_END) != 0) {
+        throw std::runtime_error("could not seek in " + path + ": " + std::strerror(errno));
+    }
+    long bytes = std::ftell(file);
+    std::rewind(file);
+    if (bytes < 0) {
+        throw std::runtime_error("could not seek in " + path + ": " + std::strerror(errno));
+    }
+    return static_cast<std::uint64_t>(bytes);
+}
+
+} // namespace
+
+void saveDataSetFile(const std::string& path, const std::vector<int>& keys, const DataSetFileInfo& info) {
+    if (info.distribution.size() >= DISTRIBUTION_BYTES) {
+        throw std::invalid_argument("data set distribution '" + info.distribution + "' is longer than " +
+                                    std::to_string(DISTRIBUTION_BYTES - 1) + " characters");
+    }
+
+    unsigned char header[HEADER_BYTES] = {};
+    std::memcpy(header, MAGIC, sizeof(MAGIC));
+    put<std::uint32_t>(header, 8, VERSION);
+    put<std::uint32_t>(header, 12, static_cast<std::uint32_t>(info.elementType));
+    put<std::uint64_t>(header, 16, keys.size());
+    put<std::uint64_t>(header, 24, info.seed);
+    put<std::uint32_t>(header, 32, info.hasSeed ? FLAG_HAS_SEED : 0);
+    std::memcpy(header + DISTRIBUTION_OFFSET, info.distribution.data(), info.distribution.size());
+
+    File file = openFile(path, "wb");
+    if (std::fwrite(header, 1, HEADER_BYTES, file.get()) != HEADER_BYTES ||
+        std::fwrite(keys.data(), sizeof(int), keys.size(), file.get()) != keys.size()) {
+        throw std::runtime_error("could not write " + path + ": " + std::strerror(errno));
+    }
+    if (std::fclose(file.release()) != 0) {
+        throw std::runtime_error("could not write " + path + ": " + std::strerror(errno));
+    }
+}
+
+DataSetFileInfo readDataSetFileInfo(const std::string& path) {
+    File file = openFile(path, "rb");
+    std::uint64_t bytes = fileSize(file.get(), path);
+    unsigned char header[HEADER_BYTES] = {};
+    if (bytes >= HEADER_BYTES && std::fread(header, 1, HEADER_BYTES, file.get()) != HEADER_BYTES) {
+        throw std::runtime_error("could not read " + path + ": " + std::strerror(errno));
+    }
+    return parseHeader(header, bytes, path);
+}
+
+#ifdef SORTING_HAVE_MMAP
+
+MappedDataSet::MappedDataSet(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("could not open " + path + ": " + std::strerror(errno));
+    }
+    struct stat status;
+    if (::fstat(fd, &status) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw std::runtime_error("could not read " + path + ": " + std::strerror(error));
+    }
+    if (static_cast<std::uint64_t>(status.st_size) < HEADER_BYTES) {
+        ::close(fd);
+        throw std::runtime_error(path + " is not a data set file");
+    }
+
+    // The mapping stays valid after the descriptor is closed. It is private,
+    // so even a stray write could not reach the file.
+    mappingBytes = static_cast<size_t>(status.st_size);
+    mapping = ::mmap(nullptr, mappingBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    int error = errno;
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        throw std::runtime_error("could not map " + path + ": " + std::strerror(error));
+    }
+
+    try {
+        fileInfo = parseHeader(static_cast<const unsigned char*>(mapping), mappingBytes, path);
+    } catch (...) {
+        ::munmap(mapping, mappingBytes);
+        throw;
+    }
+    keys = reinterpret_cast<const int*>(static_cast<const unsigned char*>(mapping) + HEADER_BYTES);
+
+    // Every sample copies all of the keys, so read them in up front
+    ::madvise(mapping, mappingBytes, MADV_WILLNEED);
+}
+
+MappedDataSet::~MappedDataSet() {
+    if (mapping) {
+        ::munmap(mapping, mappingBytes);
+    }
+}
+
+#else
+
+MappedDataSet::MappedDataSet(const std::string& path) {
+    fileInfo = readDataSetFileInfo(path);
+    File file = openFile(path, "rb");
+    fallback.resize(static_cast<size_t>(fileInfo.count));
+    if (std::fseek(file.get(), static_cast<long>(HEADER_BYTES), SEEK_SET) != 0 ||
+        std::fread(fallback.data(), sizeof(int), fallback.size(), file.get()) != fallback.size()) {
+        throw std::runtime_error("could not read " + path + ": " + std::strerror(errno));
+    }
+    keys = fallback.data();
+}
+
+MappedDataSet::~MappedDataSet() = default;
+
+#endif
@@ -0,0 +1,475 @@
+#include "../include/external_sort.h"
+#include "../include/loser_tree.h"
+#include "../include/utils.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+static_assert(sizeof(int) == 4, "the external sort reads and writes 32-bit keys as int");
+
+namespace {
+
+// Chunks smaller than this are not worth a run file
+constexpr std::size_t MIN_CHUNK_ELEMENTS = 1024;
+
+// Merge buffers: at least a page, unless the budget leaves no choice, and no
+// larger than sequential transfers need
+constexpr std::size_t MIN_MERGE_BUFFER_BYTES = 4096;
+constexpr std::size_t MAX_MERGE_BUFFER_BYTES = std::size_t(16) << 20;
+
+using File = std::unique_ptr<std::FILE, int (*)(std::FILE*)>;
+
+File openFile(const std::string& path, const char* mode) {
+    std::FILE* file = std::fopen(path.c_str(), mode);
+    if (!file) {
+        throw std::runtime_error("could not open " + path + ": " + std::strerror(errno));
+    }
+    return File(file, std::fclose);
+}
+
+// Read up to count keys; fewer only at the end of the file
+std::size_t readKeys(std::FILE* file, int* data, std::size_t count, const std::string& path) {
+    std::size_t read = std::fread(data, sizeof(int), count, file);
+    if (read < count && std::ferror(file)) {
+        throw std::runtime_error("could not read " + path);
+    }
+    return read;
+}
+
+void writeKeys(std::FILE* file, const int* data, std::size_t count, const std::string& path) {
+    if (std::fwrite(data, sizeof(int), count, file) != count) {
+        throw std::runtime_error("could not write " + path + ": " + std::strerror(errno));
+    }
+}
+
+void closeFile(File& file, const std::string& path) {
+    if (std::fclose(file.release()) != 0) {
+        throw std::runtime_error("could not write " + path + ": " + std::strerror(errno));
+    }
+}
+
+// One background thread that runs block transfers in submission order, so
+// the disk sees them one at a time
+class IoThread {
+public:
+    IoThread() : thread_([this] { loop(); }) {}
+
+    ~IoThread() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wakeUp_.notify_one();
+        thread_.join();
+    }
+
+    IoThread(const IoThread&) = delete;
+    IoThread& operator=(const IoThread&) = delete;
+
+    // The future carries the job's result or its exception
+    std::future<std::size_t> submit(std::function<std::size_t()> job) {
+        std::packaged_task<std::size_t()> task(std::move(job));
+        std::future<std::size_t> result = task.get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        wakeUp_.notify_one();
+        return result;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable wakeUp_;
+    std::deque<std::packaged_task<std::size_t()>> tasks_;
+    bool stopping_ = false;
+    std::thread thread_;
+
+    // Runs until stopped and out of work, so no submitted job is dropped
+    void loop() {
+        while (true) {
+            std::packaged_task<std::size_t()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wakeUp_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty()) {
+                    return;
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+};
+
+// Streams a run file through two buffers: the merge consumes one while the
+// I/O thread fills the other
+class RunReader {
+public:
+    RunReader(const std::string& path, std::size_t bufferElements, IoThread& io)
+        : path_(path), file_(openFile(path, "rb")), io_(io), capacity_(bufferElements) {
+        buffers_[0].resize(capacity_);
+        buffers_[1].resize(capacity_);
+        show(0, readKeys(file_.get(), buffers_[0].data(), capacity_, path_));
+    }
+
+    ~RunReader() {
+        if (pending_.valid()) {
+            pending_.wait();
+        }
+    }
+
+    RunReader(const RunReader&) = delete;
+    RunReader& operator=(const RunReader&) = delete;
+
+    bool exhausted() const { return position_ == end_; }
+    const int& value() const { return *position_; }
+
+    void advance() {
+        if (++position_ == end_) {
+            next();
+        }
+    }
+
+private:
+    std::string path_;
+    File file_;
+    IoThread& io_;
+    std::size_t capacity_;
+    std::vector<int> buffers_[2];
+    int current_ = 0;
+    const int* position_ = nullptr;
+    const int* end_ = nullptr;
+    std::future<std::size_t> pending_;
+
+    // Make buffer b current and, unless the file ended, fill the other one
+    void show(int b, std::size_t count) {
+        current_ = b;
+        position_ = buffers_[b].data();
+        end_ = position_ + count;
+        if (count == capacity_) {
+            int other = 1 - b;
+            pending_ = io_.submit([this, other] {
+                return readKeys(file_.get(), buffers_[other].data(), capacity_, path_);
+            });
+        }
+    }
+
+    void next() {
+        if (pending_.valid()) {
+            show(1 - current_, pending_.get());
+        }
+    }
+};
+
+// Input iterator over a RunReader, for the loser tree; a default-constructed
+// cursor is the end of every run
+class RunCursor {
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = int;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const int*;
+    using reference = const int&;
+
+    RunCursor() = default;
+    explicit RunCursor(RunReader* reader) : reader_(reader) {}
+
+    reference operator*() const { return reader_->value(); }
+
+    RunCursor& operator++() {
+        reader_->advance();
+        return *this;
+    }
+
+    bool operator==(const RunCursor& other) const { return atEnd() == other.atEnd(); }
+    bool operator!=(const RunCursor& other) const { return !(*this == other); }
+
+private:
+    RunReader* reader_ = nullptr;
+
+    bool atEnd() const { return !reader_ || reader_->exhausted(); }
+};
+
+// Collects keys in one buffer while the I/O thread writes out the other
+class RunWriter {
+public:
+    RunWriter(const std::string& path, std::size_t bufferElements, IoThread& io)
+        : path_(path), file_(openFile(path, "wb")), io_(io) {
+        buffers_[0].resize(bufferElements);
+        buffers_[1].resize(bufferElements);
+        start(0);
+    }
+
+    ~RunWriter() {
+        if (pending_.valid()) {
+            pending_.wait();
+        }
+    }
+
+    RunWriter(const RunWriter&) = delete;
+    RunWriter& operator=(const RunWriter&) = delete;
+
+    void put(int value) {
+        *position_ = value;
+        if (++position_ == end_) {
+            flush();
+        }
+    }
+
+    // Write what is left and close the file
+    void finish() {
+        flush();
+        if (pending_.valid()) {
+            pending_.get();
+        }
+        closeFile(file_, path_);
+    }
+
+private:
+    std::string path_;
+    File file_;
+    IoThread& io_;
+    std::vector<int> buffers_[2];
+    int current_ = 0;
+    int* position_ = nullptr;
+    int* end_ = nullptr;
+    std::future<std::size_t> pending_;
+
+    void start(int b) {
+        current_ = b;
+        position_ = buffers_[b].data();
+        end_ = position_ + buffers_[b].size();
+    }
+
+    void flush() {
+        std::size_t count = static_cast<std::size_t>(position_ - buffers_[current_].data());
+        if (count == 0) {
+            return;
+        }
+        // The other buffer is free once its own write is done
+        if (pending_.valid()) {
+            pending_.get();
+        }
+        int b = current_;
+        pending_ = io_.submit([this, b, count] {
+            writeKeys(file_.get(), buffers_[b].data(), count, path_);
+            return count;
+        });
+        start(1 - b);
+    }
+};
+
+// Run files of one sort, removed when it finishes or fails
+class TempFiles {
+public:
+    explicit TempFiles(std::string directory) : directory_(std::move(directory)) {
+        // A random prefix keeps concurrent sorts in one directory apart
+        char prefix[32];
+        std::snprintf(prefix, sizeof(prefix), "sort-%016llx",
+                      static_cast<unsigned long long>(randomSeed()));
+        prefix_ = prefix;
+    }
+
+    ~TempFiles() {
+        for (const std::string& path : paths_) {
+            std::remove(path.c_str());
+        }
+    }
+
+    TempFiles(const TempFiles&) = delete;
+    TempFiles& operator=(const TempFiles&) = delete;
+
+    std::string create() {
+        std::filesystem::path path = std::filesystem::path(directory_) /
+                                     (prefix_ + "-" + std::to_string(paths_.size()) + ".run");
+        paths_.push_back(path.string());
+        return paths_.back();
+    }
+
+    void remove(const std::string& path) {
+        std::remove(path.c_str());
+    }
+
+private:
+    std::string directory_;
+    std::string prefix_;
+    std::vector<std::string> paths_;
+};
+
+void mergeFiles(const std::vector<std::string>& inputs, const std::string& output,
+                std::size_t bufferElements, IoThread& readIo, IoThread& writeIo) {
+    std::vector<std::unique_ptr<RunReader>> readers;
+    std::vector<std::pair<RunCursor, RunCursor>> runs;
+    for (const std::string& input : inputs) {
+        readers.push_back(std::make_unique<RunReader>(input, bufferElements, readIo));
+        runs.emplace_back(RunCursor(readers.back().get()), RunCursor());
+    }
+
+    RunWriter writer(output, bufferElements, writeIo);
+    sorting::LoserTree<RunCursor> tree(std::move(runs));
+    while (!tree.empty()) {
+        writer.put(tree.top());
+        tree.pop();
+    }
+    writer.finish();
+}
+
+// base^exponent, saturating at limit
+std::size_t powerUpTo(std::size_t base, std::size_t exponent, std::size_t limit) {
+    std::size_t result = 1;
+    for (std::size_t i = 0; i < exponent && result < limit; i++) {
+        result = result > limit / base ? limit : result * base;
+    }
+    return std::min(result, limit);
+}
+
+// Runs merged at once when merging runs with budget bytes of buffers. Every
+// pass reads and writes all of the data, so the fewest passes come first:
+// as many as pages for two buffers per run (and two for the output) need.
+// Within that number of passes, the fan-in is the smallest that still
+// reaches every run, which leaves each buffer as large as possible.
+std::size_t mergeFanIn(std::size_t runs, std::size_t budget) {
+    std::size_t widest = budget / (2 * MIN_MERGE_BUFFER_BYTES);
+    widest = std::max<std::size_t>(widest > 0 ? widest - 1 : 0, 2);
+    if (widest >= runs) {
+        return runs;
+    }
+
+    std::size_t passes = 1;
+    while (powerUpTo(widest, passes, runs) < runs) {
+        passes++;
+    }
+    std::size_t fanIn = 2;
+    while (powerUpTo(fanIn, passes, runs) < runs) {
+        fanIn++;
+    }
+    return fanIn;
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+ExternalSortStats externalSort(
+    const std::string& inputPath,
+    const std::string& outputPath,
+    SortingAlgorithm& algorithm,
+    const ExternalSortOptions& options
+) {
+    ExternalSortStats stats;
+
+    // Algorithms with O(n) space need a buffer as large as the chunk
+    stats.chunkElements = options.memoryBudget / sizeof(int) / (algorithm.usesLinearScratch() ? 2 : 1);
+    if (stats.chunkElements < MIN_CHUNK_ELEMENTS) {
+        throw std::invalid_argument("memory budget of " + std::to_string(options.memoryBudget) +
+                                    " bytes is too small to sort in");
+    }
+
+    std::error_code error;
+    std::uintmax_t inputBytes = std::filesystem::file_size(inputPath, error);
+    if (error) {
+        throw std::runtime_error("could not read " + inputPath + ": " + error.message());
+    }
+    if (inputBytes % sizeof(int) != 0) {
+        throw std::invalid_argument(inputPath + " is not a whole number of 32-bit keys");
+    }
+    stats.elements = static_cast<std::size_t>(inputBytes / sizeof(int));
+
+    std::string directory = options.tempDirectory;
+    if (directory.empty()) {
+        directory = std::filesystem::path(outputPath).parent_path().string();
+        if (directory.empty()) {
+            directory = ".";
+        }
+    }
+    TempFiles temp(directory);
+
+    // Run formation: sort chunks in memory and spill them
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::string> runs;
+    {
+        File input = openFile(inputPath, "rb");
+        std::vector<int> chunk;
+        std::size_t remaining = stats.elements;
+        do {
+            chunk.resize(std::min(remaining, stats.chunkElements));
+            std::size_t count = readKeys(input.get(), chunk.data(), chunk.size(), inputPath);
+            if (count != chunk.size()) {
+                throw std::runtime_error(inputPath + " ended early");
+            }
+            remaining -= count;
+            algorithm.sort(chunk);
+
+            // Input that fits in one chunk goes straight to the output
+            std::string path = runs.empty() && remaining == 0 ? outputPath : temp.create();
+            File run = openFile(path, "wb");
+            writeKeys(run.get(), chunk.data(), chunk.size(), path);
+            closeFile(run, path);
+            runs.push_back(path);
+        } while (remaining > 0);
+    }
+    algorithm.releaseMemory();
+    stats.runs = runs.size();
+    stats.runFormationMs = millisecondsSince(start);
+
+    if (runs.size() == 1) {
+        return stats;
+    }
+
+    // Two buffers per input run and two for the output. The fan-in is
+    // settled first, then its buffers share the budget; more runs than the
+    // budget buffers at once are merged in several passes.
+    stats.fanIn = mergeFanIn(runs.size(), options.memoryBudget);
+    std::size_t bufferBytes = options.memoryBudget / (2 * (stats.fanIn + 1));
+    bufferBytes = std::min(bufferBytes, MAX_MERGE_BUFFER_BYTES);
+    if (bufferBytes >= 4096) {
+        bufferBytes -= bufferBytes % 4096;
+    }
+    std::size_t bufferElements = std::max<std::size_t>(bufferBytes / sizeof(int), 1);
+    stats.bufferBytes = bufferElements * sizeof(int);
+
+    start = std::chrono::steady_clock::now();
+    IoThread readIo;
+    IoThread writeIo;
+    while (runs.size() > stats.fanIn) {
+        std::vector<std::string> merged;
+        for (std::size_t first = 0; first < runs.size(); first += stats.fanIn) {
+            std::vector<std::string> group(runs.begin() + first,
+                                           runs.begin() + std::min(first + stats.fanIn, runs.size()));
+            if (group.size() == 1) {
+                merged.push_back(group.front());
+                continue;
+            }
+            std::string path = temp.create();
+            mergeFiles(group, path, bufferElements, readIo, writeIo);
+            for (const std::string& run : group) {
+                temp.remove(run);
+            }
+            merged.push_back(path);
+        }
+        runs.swap(merged);
+        stats.mergePasses++;
+    }
+    mergeFiles(runs, outputPath, bufferElements, readIo, writeIo);
+    stats.mergePasses++;
+    stats.mergeMs = millisecondsSince(start);
+    return stats;
+}
@@ -1,42 +1,43 @@
 #include "../include/sorting.h"
+#include "../include/sort_algorithms.h"
+#include "../include/op_counter.h"
+#include <stdexcept>
 
-void HeapSort::sort(std::vector<int>& arr) {
-    int n = arr.size();
-    
-    // Build heap (rearrange array)
-    for (int i = n / 2 - 1; i >= 0; i--)
-        heapify(arr, n, i);
-    
-    // One by one extract an element from heap
-    for (int i = n - 1; i > 0; i--) {
-        // Move current root to end
-        std::swap(arr[0], arr[i]);
-        
-        // Call max heapify on the reduced heap
-        heapify(arr, i, 0);
+namespace {
+
+template <typename RandomIt, typename Compare>
+void heapSortWithArity(int arity, RandomIt first, RandomIt last, Compare comp) {
+    switch (arity) {
+        case 4:
+            sorting::dAryHeapSort<4>(first, last, comp);
+            break;
+        case 8:
+            sorting::dAryHeapSort<8>(first, last, comp);
+            break;
+        default:
+            sorting::heapSort(first, last, comp);
+            break;
     }
 }
 
-// To heapify a subtree rooted with node i which is
-// an index in arr[]. n is size of heap
-void HeapSort::heapify(std::vector<int>& arr, int n, int i) {
-    int largest = i;     // Initialize largest as root
-    int left = 2 * i + 1;    // left = 2*i + 1
-    int right = 2 * i + 2;   // right = 2*i + 2
-    
-    // If left child is larger than root
-    if (left < n && arr[left] > arr[largest])
-        largest = left;
-    
-    // If right child is larger than largest so far
-    if (right < n && arr[right] > arr[largest])
-        largest = right;
-    
-    // If largest is not root
-    if (largest != i) {
-        std::swap(arr[i], arr[largest]);
-        
-        // Recursively heapify the affected sub-tree
-        heapify(arr, n, largest);
+} // namespace
+
+HeapSort::HeapSort(int arity) : arity(arity) {
+    if (arity != 2 && arity != 4 && arity != 8) {
+        throw std::invalid_argument("HeapSort: arity must be 2, 4 or 8");
     }
-}
\ No newline at end of file
+}
+
+std::string HeapSort::getName() const {
+    return arity == 2 ? "Heap Sort" : std::to_string(arity) + "-ary Heap Sort";
+}
+
+void HeapSort::sort(std::vector<int>& arr) {
+    heapSortWithArity(arity, arr.begin(), arr.end(), std::less<int>());
+}
+
+OperationCounts HeapSort::countOperations(const std::vector<int>& data) {
+    return sorting::countOperations(data, [this](auto first, auto last) {
+        heapSortWithArity(arity, first, last, std::less<>());
+    });
+}
@@ -1,18 +1,13 @@
 #include "../include/sorting.h"
+#include "../include/sort_algorithms.h"
+#include "../include/op_counter.h"
 
 void InsertionSort::sort(std::vector<int>& arr) {
-    int n = arr.size();
-    
-    for (int i = 1; i < n; i++) {
-        int key = arr[i];
-        int j = i - 1;
-        
-        // Move elements of arr[0..i-1] that are greater than key
-        // to one position ahead of their current position
-        while (j >= 0 && arr[j] > key) {
-            arr[j + 1] = arr[j];
-            j = j - 1;
-        }
-        arr[j + 1] = key;
-    }
-}
\ No newline at end of file
+    sorting::insertionSort(arr.begin(), arr.end(), std::less<int>());
+}
+
+OperationCounts InsertionSort::countOperations(const std::vector<int>& data) {
+    return sorting::countOperations(data, [](auto first, auto last) {
+        sorting::insertionSort(first, last, std::less<>());
+    });
+}
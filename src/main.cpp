@@ -4,18 +4,24 @@
 #include <string>
 #include <chrono>
 #include <iomanip>
+#include <stdexcept>
+#include "../include/cli.h"
+#include "../include/matrix_runner.h"
 #include "../include/sorting.h"
 #include "../include/utils.h"
 
-int main(int argc, char* argv[]) {
-    std::cout << "CSE331 - Sorting Algorithm Analysis" << std::endl;
-    std::cout << "====================================" << std::endl;
-    
-    // Create instances of all sorting algorithms
+// Create instances of all sorting algorithms; threadCount sizes the pools of
+// the parallel ones (0 = one thread per hardware thread)
+static std::vector<std::unique_ptr<SortingAlgorithm>> createAlgorithms(size_t threadCount) {
     std::vector<std::unique_ptr<SortingAlgorithm>> algorithms;
     algorithms.push_back(std::make_unique<MergeSort>());
     algorithms.push_back(std::make_unique<HeapSort>());
+    algorithms.push_back(std::make_unique<HeapSort>(4));
+    algorithms.push_back(std::make_unique<HeapSort>(8));
     algorithms.push_back(std::make_unique<QuickSort>());
+    algorithms.push_back(std::make_unique<PdqSort>());
+    algorithms.push_back(std::make_unique<LsdRadixSort>());
+    algorithms.push_back(std::make_unique<MsdRadixSort>());
     algorithms.push_back(std::make_unique<BubbleSort>());
     algorithms.push_back(std::make_unique<InsertionSort>());
     algorithms.push_back(std::make_unique<SelectionSort>());
@@ -24,6 +30,45 @@ int main(int argc, char* argv[]) {
     algorithms.push_back(std::make_unique<CombSort>());
     algorithms.push_back(std::make_unique<TimSort>());
     algorithms.push_back(std::make_unique<CocktailSort>());
+    algorithms.push_back(std::make_unique<ParallelMergeSort>(threadCount));
+    algorithms.push_back(std::make_unique<ParallelQuickSort>(threadCount));
+    algorithms.push_back(std::make_unique<ParallelRadixSort>(threadCount));
+    return algorithms;
+}
+
+int main(int argc, char* argv[]) {
+    // Any argument selects the non-interactive command line
+    if (argc > 1) {
+        BenchmarkOptions options;
+        try {
+            options = parseCommandLine(argc, argv);
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            printUsage(std::cerr, argv[0]);
+            return 2;
+        }
+        
+        if (options.showHelp) {
+            printUsage(std::cout, argv[0]);
+            return 0;
+        }
+        if (!options.compareBaseline.empty()) {
+            return runComparison(options);
+        }
+        if (!options.writeDataDirectory.empty()) {
+            return writeDataSets(options);
+        }
+        if (!options.externalInput.empty()) {
+            return runExternalSort(options, createAlgorithms);
+        }
+        
+        return runCommandLine(options, createAlgorithms);
+    }
+    
+    std::cout << "CSE331 - Sorting Algorithm Analysis" << std::endl;
+    std::cout << "====================================" << std::endl;
+    
+    std::vector<std::unique_ptr<SortingAlgorithm>> algorithms = createAlgorithms(0);
     
     // Create a vector of raw pointers for the runAllAlgorithms function
     std::vector<SortingAlgorithm*> algorithmPtrs;
@@ -68,8 +113,15 @@ int main(int argc, char* argv[]) {
         case 1: {
             // Quick test with a small random array
             std::cout << "\nRunning quick test with random data (size=1000)..." << std::endl;
-            std::vector<int> data = generateRandomData(1000);
+            std::uint64_t seed = randomSeed();
+            std::vector<int> data = generateRandomData(1000, 0, 1000, seed);
             std::vector<SortingResult> results = runAllAlgorithms(algorithmPtrs, data);
+            for (auto& result : results) {
+                result.dataSetName = dataSetName(DataSetType::RANDOM);
+                result.dataSize = data.size();
+                result.dataSeed = seed;
+                result.hasDataSeed = true;
+            }
             printResults(results);
             saveResultsToCSV(results, "quick_test_results.csv");
             break;
@@ -79,42 +131,16 @@ int main(int argc, char* argv[]) {
             std::cout << "\nRunning full benchmark..." << std::endl;
             std::cout << "This may take a while for large data sizes." << std::endl;
             
-            std::vector<SortingResult> allResults;
-            
-            // For each data size
-            for (size_t size : dataSizes) {
-                std::cout << "\nTesting with data size: " << size << std::endl;
-                
-                // For each data type
-                std::vector<DataSetType> dataTypes = {
-                    DataSetType::RANDOM, 
-                    DataSetType::SORTED_ASC, 
-                    DataSetType::SORTED_DESC, 
-                    DataSetType::PARTIALLY_SORTED
-                };
-                
-                std::vector<std::string> dataTypeNames = {
-                    "Random", "Sorted (Asc)", "Sorted (Desc)", "Partially Sorted"
-                };
-                
-                for (size_t i = 0; i < dataTypes.size(); i++) {
-                    std::cout << "  Data type: " << dataTypeNames[i] << std::endl;
-                    
-                    // Generate data
-                    std::vector<int> data = generateDataSet(dataTypes[i], size);
-                    
-                    // Run all algorithms
-                    std::vector<SortingResult> results = runAllAlgorithms(algorithmPtrs, data);
-                    
-                    // Add dataset info to algorithm names
-                    for (auto& result : results) {
-                        result.algorithmName += " [" + dataTypeNames[i] + ", n=" + std::to_string(size) + "]";
-                    }
-                    
-                    // Add to all results
-                    allResults.insert(allResults.end(), results.begin(), results.end());
-                }
-            }
+            // Cells run side by side, one per physical core; quadratic
+            // sorts stop at 100000 elements
+            MatrixOptions matrix;
+            matrix.sizes = dataSizes;
+            matrix.seed = randomSeed();
+            matrix.jobs = 0;
+            matrix.pinThreads = true;
+            matrix.physicalCoresOnly = true;
+            matrix.maxQuadraticSize = 100000;
+            std::vector<SortingResult> allResults = runBenchmarkMatrix(matrix, createAlgorithms, std::cout);
             
             // Print and save all results
             printResults(allResults);
@@ -152,32 +178,34 @@ int main(int argc, char* argv[]) {
             size_t customSize;
             std::cin >> customSize;
             
+            const std::vector<DataSetType>& dataTypes = allDataSetTypes();
             std::cout << "Choose data type:" << std::endl;
-            std::cout << "1. Random" << std::endl;
-            std::cout << "2. Sorted (Ascending)" << std::endl;
-            std::cout << "3. Sorted (Descending)" << std::endl;
-            std::cout << "4. Partially Sorted" << std::endl;
-            std::cout << "Enter your choice (1-4): ";
+            for (size_t i = 0; i < dataTypes.size(); i++) {
+                std::cout << i + 1 << ". " << dataSetName(dataTypes[i]) << std::endl;
+            }
+            std::cout << "Enter your choice (1-" << dataTypes.size() << "): ";
             
-            int dataTypeChoice;
+            size_t dataTypeChoice;
             std::cin >> dataTypeChoice;
             
-            DataSetType dataType;
-            switch (dataTypeChoice) {
-                case 1: dataType = DataSetType::RANDOM; break;
-                case 2: dataType = DataSetType::SORTED_ASC; break;
-                case 3: dataType = DataSetType::SORTED_DESC; break;
-                case 4: dataType = DataSetType::PARTIALLY_SORTED; break;
-                default: 
-                    std::cerr << "Invalid choice!" << std::endl;
-                    return 1;
+            if (dataTypeChoice < 1 || dataTypeChoice > dataTypes.size()) {
+                std::cerr << "Invalid choice!" << std::endl;
+                return 1;
             }
+            DataSetType dataType = dataTypes[dataTypeChoice - 1];
             
             // Generate data
-            std::vector<int> data = generateDataSet(dataType, customSize);
+            std::uint64_t seed = randomSeed();
+            std::vector<int> data = generateDataSet(dataType, customSize, seed);
             
             // Run all algorithms
             std::vector<SortingResult> results = runAllAlgorithms(algorithmPtrs, data);
+            for (auto& result : results) {
+                result.dataSetName = dataSetName(dataType);
+                result.dataSize = customSize;
+                result.dataSeed = seed;
+                result.hasDataSeed = true;
+            }
             
             printResults(results);
             saveResultsToCSV(results, "custom_test_results.csv");
@@ -0,0 +1,370 @@
+#include "../include/matrix_runner.h"
+#include "../include/dataset_file.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+std::uint64_t dataSetSeed(std::uint64_t seed, size_t size, DataSetType type) {
+    std::uint64_t x = seed ^ (static_cast<std::uint64_t>(size) * 0x9E3779B97F4A7C15ULL) ^
+                      (static_cast<std::uint64_t>(type) << 56);
+
+    // splitmix64 finalizer
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+#ifdef __linux__
+// A topology id of a CPU from sysfs, or -1 when it cannot be read
+static int readTopology(int cpu, const char* name) {
+    std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/" + name);
+    int value = -1;
+    if (!(file >> value)) {
+        return -1;
+    }
+    return value;
+}
+#endif
+
+std::vector<int> usableCpus(bool physicalCoresOnly) {
+    std::vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+        return cpus;
+    }
+
+    std::set<std::pair<int, int>> cores;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &set)) {
+            continue;
+        }
+        if (physicalCoresOnly) {
+            // CPUs with unknown topology count as cores of their own
+            int package = readTopology(cpu, "physical_package_id");
+            int core = readTopology(cpu, "core_id");
+            if (core >= 0 && !cores.insert({package, core}).second) {
+                continue;
+            }
+        }
+        cpus.push_back(cpu);
+    }
+#else
+    (void)physicalCoresOnly;
+#endif
+    return cpus;
+}
+
+// Restrict the calling thread to one CPU; returns an error message on failure
+static std::string pinCurrentThread(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        return std::strerror(errno);
+    }
+    return "";
+#else
+    (void)cpu;
+    return "not supported on this platform";
+#endif
+}
+
+// Display name of a data set file's distribution: the name of a generated
+// type, the label of captured keys, or else the file name
+static std::string fileDataSetName(const DataSetFileInfo& info, const std::string& path) {
+    for (DataSetType type : allDataSetTypes()) {
+        if (dataSetKey(type) == info.distribution) {
+            return dataSetName(type);
+        }
+    }
+    if (!info.distribution.empty()) {
+        return info.distribution;
+    }
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+// Expected growth of the running time from size `from` to size `to`
+static double growth(size_t from, size_t to, bool quadratic) {
+    double ratio = static_cast<double>(to) / static_cast<double>(std::max<size_t>(from, 1));
+    if (quadratic) {
+        return ratio * ratio;
+    }
+    double logFrom = std::max(std::log2(static_cast<double>(from)), 1.0);
+    double logTo = std::max(std::log2(static_cast<double>(to)), 1.0);
+    return ratio * logTo / logFrom;
+}
+
+namespace {
+
+// One data set, generated or mapped from a file, shared by every chain that
+// uses it and freed once the last of them is done with it
+struct DataSlot {
+    std::once_flag loaded;
+    std::vector<int> data;
+    std::unique_ptr<MappedDataSet> file;
+    const int* keys = nullptr;
+    size_t size = 0;
+    std::string name;
+    std::uint64_t seed = 0;
+    bool hasSeed = false;
+    std::atomic<size_t> users{0};
+};
+
+// The cells of one algorithm on one distribution (or data set file)
+struct Chain {
+    size_t algorithm; // index into the factory's algorithms
+    size_t selected;  // index into the selected algorithms
+    size_t type;      // index into options.distributions, or dataSetFiles
+};
+
+} // namespace
+
+std::vector<SortingResult> runBenchmarkMatrix(
+    const MatrixOptions& options,
+    const AlgorithmFactory& factory,
+    std::ostream& progress
+) {
+    // These instances run the multi-threaded algorithms and describe all
+    std::vector<std::unique_ptr<SortingAlgorithm>> shared = factory(options.threadCount);
+
+    std::vector<size_t> selected = options.algorithms;
+    if (selected.empty()) {
+        for (size_t i = 0; i < shared.size(); i++) {
+            selected.push_back(i);
+        }
+    }
+
+    // Data set files form a single row, one column per file
+    const bool fromFiles = !options.dataSetFiles.empty();
+    const size_t sizeCount = fromFiles ? 1 : options.sizes.size();
+    const size_t typeCount = fromFiles ? options.dataSetFiles.size() : options.distributions.size();
+    const size_t algorithmCount = selected.size();
+
+    std::vector<size_t> sizeOrder(sizeCount);
+    for (size_t i = 0; i < sizeCount; i++) {
+        sizeOrder[i] = i;
+    }
+    if (!fromFiles) {
+        std::stable_sort(sizeOrder.begin(), sizeOrder.end(), [&](size_t a, size_t b) {
+            return options.sizes[a] < options.sizes[b];
+        });
+    }
+
+    std::vector<std::unique_ptr<DataSlot>> slots;
+    for (size_t i = 0; i < sizeCount * typeCount; i++) {
+        slots.push_back(std::make_unique<DataSlot>());
+        slots.back()->users = algorithmCount;
+    }
+
+    std::vector<SortingResult> cells(sizeCount * typeCount * algorithmCount);
+    std::vector<char> done(cells.size(), 0);
+
+    // Quadratic chains are the longest, so they start first
+    std::vector<Chain> serialChains;
+    std::vector<Chain> parallelChains;
+    for (size_t s = 0; s < algorithmCount; s++) {
+        for (size_t t = 0; t < typeCount; t++) {
+            Chain chain{selected[s], s, t};
+            (shared[selected[s]]->getThreadCount() > 1 ? parallelChains : serialChains).push_back(chain);
+        }
+    }
+    std::stable_sort(serialChains.begin(), serialChains.end(), [&](const Chain& a, const Chain& b) {
+        return shared[a.algorithm]->isQuadratic() && !shared[b.algorithm]->isQuadratic();
+    });
+
+    std::mutex progressMutex;
+    auto report = [&](const std::string& line) {
+        std::lock_guard<std::mutex> lock(progressMutex);
+        progress << line << std::endl;
+    };
+
+    // Generate the data set of a slot, or map its file, on first use
+    auto load = [&](DataSlot& slot, size_t s, size_t t) {
+        std::call_once(slot.loaded, [&] {
+            if (fromFiles) {
+                slot.file = std::make_unique<MappedDataSet>(options.dataSetFiles[t]);
+                const DataSetFileInfo& info = slot.file->info();
+                slot.keys = slot.file->data();
+                slot.size = slot.file->size();
+                slot.name = fileDataSetName(info, options.dataSetFiles[t]);
+                slot.seed = info.seed;
+                slot.hasSeed = info.hasSeed;
+            } else {
+                DataSetType type = options.distributions[t];
+                slot.seed = dataSetSeed(options.seed, options.sizes[s], type);
+                slot.hasSeed = true;
+                slot.data = generateDataSet(type, options.sizes[s], slot.seed, options.dataSetParams);
+                slot.keys = slot.data.data();
+                slot.size = slot.data.size();
+                slot.name = dataSetName(type);
+            }
+        });
+    };
+
+    auto runChain = [&](SortingAlgorithm& algorithm, const Chain& chain, const BenchmarkConfig& config,
+                        BenchmarkBuffer& buffer) {
+        bool quadratic = algorithm.isQuadratic();
+        bool skipping = false;
+        size_t previousSize = 0;
+        double previousMs = 0.0;
+
+        for (size_t s : sizeOrder) {
+            DataSlot& slot = *slots[s * typeCount + chain.type];
+
+            // A file's size is only known from its header; mapping it reads
+            // no keys yet
+            if (fromFiles) {
+                load(slot, s, chain.type);
+            }
+            size_t size = fromFiles ? slot.size : options.sizes[s];
+            std::string name = fromFiles ? slot.name : dataSetName(options.distributions[chain.type]);
+            std::string cell = "  n=" + std::to_string(size) + " " + name + ": " + algorithm.getName();
+
+            if (!skipping && quadratic && options.maxQuadraticSize > 0 && size > options.maxQuadraticSize) {
+                report(cell + " skipped (quadratic above n=" + std::to_string(options.maxQuadraticSize) + ")");
+                skipping = true;
+            }
+            if (!skipping && options.cellTimeoutMs > 0.0 && previousSize > 0) {
+                double predictedMs = previousMs * growth(previousSize, size, quadratic);
+                if (predictedMs > options.cellTimeoutMs) {
+                    report(cell + " skipped (predicted " + std::to_string(static_cast<long long>(predictedMs)) +
+                           " ms per sort, timeout " + std::to_string(static_cast<long long>(options.cellTimeoutMs)) + " ms)");
+                    skipping = true;
+                }
+            }
+
+            if (!skipping) {
+                load(slot, s, chain.type);
+                report(cell);
+
+                SortingResult result = runSortingBenchmark(algorithm, slot.keys, slot.size, config, buffer);
+
+                result.dataSetName = slot.name;
+                result.dataSize = size;
+                result.dataSeed = slot.seed;
+                result.hasDataSeed = slot.hasSeed;
+
+                size_t index = (s * typeCount + chain.type) * algorithmCount + chain.selected;
+                cells[index] = result;
+                done[index] = 1;
+
+                previousSize = size;
+                previousMs = result.executionTimeMs;
+            }
+
+            if (slot.users.fetch_sub(1) == 1) {
+                std::vector<int>().swap(slot.data);
+                slot.file.reset();
+            }
+        }
+    };
+
+    // Single-threaded chains on the workers
+    std::vector<int> cpus = usableCpus(options.physicalCoresOnly);
+    size_t jobs = options.jobs;
+    if (jobs == 0) {
+        jobs = cpus.empty() ? std::max(1u, std::thread::hardware_concurrency()) : cpus.size();
+    }
+    jobs = std::max<size_t>(1, std::min(jobs, serialChains.size()));
+
+    if (options.pinThreads && cpus.empty()) {
+        report("CPU pinning unavailable; workers are not pinned");
+    }
+
+    BenchmarkConfig workerConfig = options.config;
+    if (jobs > 1) {
+        workerConfig.concurrent = true;
+        workerConfig.countEvents = false;
+    }
+
+    std::atomic<size_t> nextChain{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto worker = [&](size_t index) {
+        try {
+            if (options.pinThreads && !cpus.empty()) {
+                int cpu = cpus[index % cpus.size()];
+                std::string pinError = pinCurrentThread(cpu);
+                if (!pinError.empty()) {
+                    report("Could not pin a worker to CPU " + std::to_string(cpu) + ": " + pinError);
+                }
+            }
+
+            // Created after pinning, so the pool threads inherit the CPU
+            std::vector<std::unique_ptr<SortingAlgorithm>> own = factory(1);
+
+            std::unique_ptr<ConcurrentBenchmarkScope> scope;
+            if (workerConfig.concurrent) {
+                scope = std::make_unique<ConcurrentBenchmarkScope>();
+            }
+
+            // Allocated by this thread, so its pages are first touched on
+            // the worker's own CPU (and NUMA node)
+            BenchmarkBuffer buffer;
+
+            while (!failed) {
+                size_t next = nextChain.fetch_add(1);
+                if (next >= serialChains.size()) {
+                    break;
+                }
+                const Chain& chain = serialChains[next];
+                runChain(*own[chain.algorithm], chain, workerConfig, buffer);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            failed = true;
+        }
+    };
+
+    if (!serialChains.empty()) {
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < jobs; i++) {
+            workers.emplace_back(worker, i);
+        }
+        for (auto& thread : workers) {
+            thread.join();
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    // Multi-threaded chains one at a time, unpinned
+    BenchmarkBuffer buffer;
+    for (const Chain& chain : parallelChains) {
+        runChain(*shared[chain.algorithm], chain, options.config, buffer);
+    }
+
+    std::vector<SortingResult> results;
+    for (size_t i = 0; i < cells.size(); i++) {
+        if (done[i]) {
+            results.push_back(cells[i]);
+        }
+    }
+    return results;
+}
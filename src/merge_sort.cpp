@@ -1,68 +1,13 @@
 #include "../include/sorting.h"
+#include "../include/sort_algorithms.h"
+#include "../include/op_counter.h"
 
 void MergeSort::sort(std::vector<int>& arr) {
-    if (arr.empty()) return;
-    mergeSort(arr, 0, arr.size() - 1);
+    sorting::mergeSort(arr.begin(), arr.end(), workspace, std::less<int>());
 }
 
-void MergeSort::mergeSort(std::vector<int>& arr, int left, int right) {
-    if (left < right) {
-        // Find the middle point
-        int mid = left + (right - left) / 2;
-        
-        // Sort first and second halves
-        mergeSort(arr, left, mid);
-        mergeSort(arr, mid + 1, right);
-        
-        // Merge the sorted halves
-        merge(arr, left, mid, right);
-    }
+OperationCounts MergeSort::countOperations(const std::vector<int>& data) {
+    return sorting::countOperations(data, [](auto first, auto last) {
+        sorting::mergeSort(first, last, std::less<>());
+    });
 }
-
-void MergeSort::merge(std::vector<int>& arr, int left, int mid, int right) {
-    // Calculate sizes of two subarrays to be merged
-    int n1 = mid - left + 1;
-    int n2 = right - mid;
-    
-    // Create temp arrays
-    std::vector<int> L(n1), R(n2);
-    
-    // Copy data to temp arrays
-    for (int i = 0; i < n1; i++)
-        L[i] = arr[left + i];
-    for (int j = 0; j < n2; j++)
-        R[j] = arr[mid + 1 + j];
-    
-    // Merge the temp arrays back
-    
-    // Initial indices of first and second subarrays
-    int i = 0, j = 0;
-    
-    // Initial index of merged subarray
-    int k = left;
-    
-    while (i < n1 && j < n2) {
-        if (L[i] <= R[j]) {
-            arr[k] = L[i];
-            i++;
-        } else {
-            arr[k] = R[j];
-            j++;
-        }
-        k++;
-    }
-    
-    // Copy the remaining elements of L[], if there are any
-    while (i < n1) {
-        arr[k] = L[i];
-        i++;
-        k++;
-    }
-    
-    // Copy the remaining elements of R[], if there are any
-    while (j < n2) {
-        arr[k] = R[j];
-        j++;
-        k++;
-    }
-}
\ No newline at end of file
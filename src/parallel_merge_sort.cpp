@@ -0,0 +1,22 @@
+#include "../include/sorting.h"
+#include "../include/parallel_sort.h"
+#include "../include/op_counter.h"
+
+ParallelMergeSort::ParallelMergeSort(size_t threadCount)
+    : pool(std::make_unique<ThreadPool>(threadCount)) {}
+
+ParallelMergeSort::~ParallelMergeSort() = default;
+
+void ParallelMergeSort::sort(std::vector<int>& arr) {
+    sorting::parallelMergeSort(arr.begin(), arr.end(), *pool, workspace, std::less<int>());
+}
+
+OperationCounts ParallelMergeSort::countOperations(const std::vector<int>& data) {
+    return sorting::countOperations(data, [this](auto first, auto last) {
+        sorting::parallelMergeSort(first, last, *pool, std::less<>());
+    });
+}
+
+size_t ParallelMergeSort::getThreadCount() const {
+    return pool->size();
+}
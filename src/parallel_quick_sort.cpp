@@ -0,0 +1,22 @@
+#include "../include/sorting.h"
+#include "../include/parallel_sort.h"
+#include "../include/op_counter.h"
+
+ParallelQuickSort::ParallelQuickSort(size_t threadCount)
+    : pool(std::make_unique<ThreadPool>(threadCount)) {}
+
+ParallelQuickSort::~ParallelQuickSort() = default;
+
+void ParallelQuickSort::sort(std::vector<int>& arr) {
+    sorting::parallelQuickSort(arr.begin(), arr.end(), *pool, std::less<int>());
+}
+
+OperationCounts ParallelQuickSort::countOperations(const std::vector<int>& data) {
+    return sorting::countOperations(data, [this](auto first, auto last) {
+        sorting::parallelQuickSort(first, last, *pool, std::less<>());
+    });
+}
+
+size_t ParallelQuickSort::getThreadCount() const {
+    return pool->size();
+}
@@ -0,0 +1,15 @@
+#include "../include/sorting.h"
+#include "../include/parallel_sort.h"
+
+ParallelRadixSort::ParallelRadixSort(size_t threadCount)
+    : pool(std::make_unique<ThreadPool>(threadCount)) {}
+
+ParallelRadixSort::~ParallelRadixSort() = default;
+
+void ParallelRadixSort::sort(std::vector<int>& arr) {
+    sorting::parallelLsdRadixSort<8>(arr.begin(), arr.end(), *pool, workspace);
+}
+
+size_t ParallelRadixSort::getThreadCount() const {
+    return pool->size();
+}
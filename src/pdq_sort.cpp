@@ -0,0 +1,13 @@
+#include "../include/sorting.h"
+#include "../include/sort_algorithms.h"
+#include "../include/op_counter.h"
+
+void PdqSort::sort(std::vector<int>& arr) {
+    sorting::pdqSort(arr.begin(), arr.end(), std::less<int>());
+}
+
+OperationCounts PdqSort::countOperations(const std::vector<int>& data) {
+    return sorting::countOperations(data, [](auto first, auto last) {
+        sorting::pdqSort(first, last, std::less<>());
+    });
+}
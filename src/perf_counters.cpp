@@ -0,0 +1,166 @@
+#include "../include/perf_counters.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Thread ids of every thread in this process
+static std::vector<pid_t> processThreads() {
+    std::vector<pid_t> threads;
+    if (DIR* dir = opendir("/proc/self/task")) {
+        while (dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] != '.') {
+                threads.push_back(static_cast<pid_t>(std::atoi(entry->d_name)));
+            }
+        }
+        closedir(dir);
+    }
+    if (threads.empty()) {
+        threads.push_back(0); // the calling thread
+    }
+    return threads;
+}
+
+static std::uint64_t cacheEvent(std::uint64_t cache, std::uint64_t op, std::uint64_t result) {
+    return cache | (op << 8) | (result << 16);
+}
+
+PerfCounters::PerfCounters() {
+    struct EventConfig {
+        std::uint32_t type;
+        std::uint64_t config;
+    };
+    const EventConfig events[EVENT_COUNT] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                                        PERF_COUNT_HW_CACHE_RESULT_MISS)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                                        PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    };
+
+    std::vector<pid_t> threads = processThreads();
+
+    for (int e = 0; e < EVENT_COUNT; e++) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = events[e].type;
+        attr.config = events[e].config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // An event counts only if it opens on every thread; a partial count
+        // would understate the parallel sorts
+        for (pid_t thread : threads) {
+            int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, thread, -1, -1, PERF_FLAG_FD_CLOEXEC));
+            if (fd < 0) {
+                if (reason.empty()) {
+                    reason = std::string("perf_event_open failed: ") + std::strerror(errno);
+                }
+                for (int opened : fds[e]) {
+                    close(opened);
+                }
+                fds[e].clear();
+                break;
+            }
+            fds[e].push_back(fd);
+        }
+    }
+
+    if (available()) {
+        reason.clear();
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (const auto& eventFds : fds) {
+        for (int fd : eventFds) {
+            close(fd);
+        }
+    }
+}
+
+void PerfCounters::start() {
+    for (const auto& eventFds : fds) {
+        for (int fd : eventFds) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+void PerfCounters::stop() {
+    for (const auto& eventFds : fds) {
+        for (int fd : eventFds) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+
+    for (int e = 0; e < EVENT_COUNT; e++) {
+        for (int fd : fds[e]) {
+            // value, time enabled, time running
+            std::uint64_t values[3] = {0, 0, 0};
+            if (::read(fd, values, sizeof(values)) != static_cast<ssize_t>(sizeof(values))) {
+                continue;
+            }
+            // Scale up counts from events that were multiplexed off the PMU
+            if (values[2] > 0) {
+                totals[e] += static_cast<double>(values[0]) * values[1] / values[2];
+            }
+        }
+    }
+}
+
+#else
+
+PerfCounters::PerfCounters() : reason("hardware counters need Linux perf_event_open") {}
+
+PerfCounters::~PerfCounters() {}
+
+void PerfCounters::start() {}
+
+void PerfCounters::stop() {}
+
+#endif
+
+void PerfCounters::reset() {
+    for (double& total : totals) {
+        total = 0.0;
+    }
+}
+
+bool PerfCounters::available() const {
+    for (const auto& eventFds : fds) {
+        if (!eventFds.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+PerfCounts PerfCounters::read(double divisor) const {
+    double value[EVENT_COUNT];
+    for (int e = 0; e < EVENT_COUNT; e++) {
+        value[e] = (fds[e].empty() || divisor <= 0.0) ? -1.0 : totals[e] / divisor;
+    }
+
+    PerfCounts counts;
+    counts.cycles = value[CYCLES];
+    counts.instructions = value[INSTRUCTIONS];
+    counts.branchMisses = value[BRANCH_MISSES];
+    counts.l1dMisses = value[L1D_MISSES];
+    counts.llcMisses = value[LLC_MISSES];
+    counts.dtlbMisses = value[DTLB_MISSES];
+    return counts;
+}
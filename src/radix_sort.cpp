@@ -0,0 +1,27 @@
+#include "../include/sorting.h"
+#include "../include/radix_sort.h"
+#include <stdexcept>
+
+LsdRadixSort::LsdRadixSort(int digitBits) : digitBits(digitBits) {
+    if (digitBits != 8 && digitBits != 11 && digitBits != 16) {
+        throw std::invalid_argument("LsdRadixSort: digit width must be 8, 11 or 16 bits");
+    }
+}
+
+void LsdRadixSort::sort(std::vector<int>& arr) {
+    switch (digitBits) {
+        case 8:
+            sorting::lsdRadixSort<8>(arr.begin(), arr.end(), workspace);
+            break;
+        case 16:
+            sorting::lsdRadixSort<16>(arr.begin(), arr.end(), workspace);
+            break;
+        default:
+            sorting::lsdRadixSort<11>(arr.begin(), arr.end(), workspace);
+            break;
+    }
+}
+
+void MsdRadixSort::sort(std::vector<int>& arr) {
+    sorting::msdRadixSort(arr.begin(), arr.end());
+}
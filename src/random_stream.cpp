@@ -0,0 +1,82 @@
+#include "../include/random_stream.h"
+#include "../include/thread_pool.h"
+#include <algorithm>
+
+Xoshiro256::Xoshiro256(std::uint64_t seed) {
+    // splitmix64 spreads any seed, including 0, over the whole state
+    for (std::uint64_t& word : state) {
+        seed += 0x9E3779B97F4A7C15ULL;
+        std::uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        word = z ^ (z >> 31);
+    }
+}
+
+void Xoshiro256::jump() {
+    static const std::uint64_t JUMP[] = {
+        0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL
+    };
+
+    std::uint64_t jumped[4] = {0, 0, 0, 0};
+    for (std::uint64_t word : JUMP) {
+        for (int bit = 0; bit < 64; bit++) {
+            if (word & (std::uint64_t(1) << bit)) {
+                for (int i = 0; i < 4; i++) {
+                    jumped[i] ^= state[i];
+                }
+            }
+            (*this)();
+        }
+    }
+    std::copy(jumped, jumped + 4, state);
+}
+
+// Below this many elements the calling thread fills everything itself
+static const std::size_t PARALLEL_FILL_THRESHOLD = std::size_t(1) << 20;
+
+// Created on first use, so runs that only generate small data sets start no
+// threads
+static ThreadPool& fillPool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void fillRandomBlocks(
+    std::vector<int>& data,
+    std::uint64_t seed,
+    const std::function<void(Xoshiro256& generator, int* first, int* last)>& fill
+) {
+    const std::size_t blocks = (data.size() + RANDOM_BLOCK_SIZE - 1) / RANDOM_BLOCK_SIZE;
+
+    // Fill blocks [begin, end); the generator starts at block 0's stream
+    auto fillRange = [&](std::size_t begin, std::size_t end) {
+        Xoshiro256 stream(seed);
+        for (std::size_t block = 0; block < begin; block++) {
+            stream.jump();
+        }
+        for (std::size_t block = begin; block < end; block++) {
+            Xoshiro256 generator = stream;
+            int* first = data.data() + block * RANDOM_BLOCK_SIZE;
+            int* last = data.data() + std::min(data.size(), (block + 1) * RANDOM_BLOCK_SIZE);
+            fill(generator, first, last);
+            stream.jump();
+        }
+    };
+
+    if (data.size() < PARALLEL_FILL_THRESHOLD) {
+        fillRange(0, blocks);
+        return;
+    }
+
+    // A few contiguous chunks of blocks per thread, so uneven fills balance
+    ThreadPool& pool = fillPool();
+    const std::size_t chunks = std::min(blocks, pool.size() * 4);
+    TaskGroup group(pool);
+    for (std::size_t chunk = 0; chunk < chunks; chunk++) {
+        std::size_t begin = blocks * chunk / chunks;
+        std::size_t end = blocks * (chunk + 1) / chunks;
+        group.run([&fillRange, begin, end] { fillRange(begin, end); });
+    }
+    group.wait();
+}
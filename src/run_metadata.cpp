@@ -0,0 +1,85 @@
+#include "../include/run_metadata.h"
+#include "../include/simd_sort.h"
+#include <ctime>
+#include <fstream>
+#include <thread>
+
+#ifdef _WIN32
+#include <cstdlib>
+#else
+#include <unistd.h>
+#endif
+
+#ifndef SORTING_GIT_HASH
+#define SORTING_GIT_HASH "unknown"
+#endif
+
+#ifndef SORTING_BUILD_FLAGS
+#define SORTING_BUILD_FLAGS "unknown"
+#endif
+
+static std::string currentTimestamp() {
+    std::time_t now = std::time(nullptr);
+    char text[32];
+    if (std::strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now)) == 0) {
+        return "unknown";
+    }
+    return text;
+}
+
+static std::string hostName() {
+#ifdef _WIN32
+    const char* name = std::getenv("COMPUTERNAME");
+    return name ? name : "unknown";
+#else
+    char name[256] = {};
+    if (gethostname(name, sizeof(name) - 1) != 0) {
+        return "unknown";
+    }
+    return name;
+#endif
+}
+
+// "model name" from /proc/cpuinfo (x86), else the first "Processor" or
+// "cpu model" line of other architectures
+static std::string cpuModel() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        std::string key = line.substr(0, line.find_last_not_of(" \t", colon - 1) + 1);
+        if (key == "model name" || key == "Processor" || key == "cpu model") {
+            size_t start = line.find_first_not_of(" \t", colon + 1);
+            return start == std::string::npos ? "unknown" : line.substr(start);
+        }
+    }
+    return "unknown";
+}
+
+static std::string compilerName() {
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+    return "unknown";
+#endif
+}
+
+RunMetadata collectRunMetadata() {
+    RunMetadata metadata;
+    metadata.timestamp = currentTimestamp();
+    metadata.host = hostName();
+    metadata.cpuModel = cpuModel();
+    metadata.logicalCpus = std::thread::hardware_concurrency();
+    metadata.isa = sorting::simd::isaName(sorting::simd::activeIsa());
+    metadata.compiler = compilerName();
+    metadata.buildFlags = SORTING_BUILD_FLAGS;
+    metadata.gitHash = SORTING_GIT_HASH;
+    return metadata;
+}
@@ -0,0 +1,483 @@
+#include "../include/simd_sort.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SORTING_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace sorting {
+namespace simd {
+
+IsaLevel detectIsa() {
+    static const IsaLevel level = [] {
+#ifdef SORTING_SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return IsaLevel::AVX2;
+        if (__builtin_cpu_supports("sse4.1")) return IsaLevel::SSE41;
+#endif
+        return IsaLevel::SCALAR;
+    }();
+    return level;
+}
+
+namespace {
+
+std::atomic<IsaLevel> isaLimit{IsaLevel::AVX2};
+
+} // namespace
+
+void limitIsa(IsaLevel level) {
+    isaLimit.store(level, std::memory_order_relaxed);
+}
+
+IsaLevel activeIsa() {
+    IsaLevel limit = isaLimit.load(std::memory_order_relaxed);
+    IsaLevel level = detectIsa();
+    return limit < level ? limit : level;
+}
+
+const char* isaName(IsaLevel level) {
+    switch (level) {
+        case IsaLevel::AVX2: return "AVX2";
+        case IsaLevel::SSE41: return "SSE4.1";
+        default: return "Scalar";
+    }
+}
+
+#ifdef SORTING_SIMD_X86
+
+namespace {
+
+// Lane operations shared by the AVX2 networks: 8 x int32 for plain keys and
+// 4 x int64 for packed key/index pairs
+struct Int32Lanes {
+    using T = int;
+    static constexpr int LANES = 8;
+
+    __attribute__((target("avx2")))
+    static void minMax(__m256i a, __m256i b, __m256i& lo, __m256i& hi) {
+        lo = _mm256_min_epi32(a, b);
+        hi = _mm256_max_epi32(a, b);
+    }
+
+    // Lanes at distance j (< LANES) swapped
+    __attribute__((target("avx2")))
+    static __m256i partner(__m256i v, int j) {
+        if (j == 4) return _mm256_permute2x128_si256(v, v, 1);
+        if (j == 2) return _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+        return _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    }
+
+    // All-ones in the lanes of a register starting at element base whose index has bit clear
+    __attribute__((target("avx2")))
+    static __m256i bitClear(int base, int bit) {
+        __m256i idx = _mm256_add_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(base));
+        return _mm256_cmpeq_epi32(_mm256_and_si256(idx, _mm256_set1_epi32(bit)), _mm256_setzero_si256());
+    }
+
+    __attribute__((target("avx2")))
+    static __m256i reverse(__m256i v) {
+        return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    }
+};
+
+struct Int64Lanes {
+    using T = std::int64_t;
+    static constexpr int LANES = 4;
+
+    // AVX2 has no 64-bit min/max, so compare once and blend both ways
+    __attribute__((target("avx2")))
+    static void minMax(__m256i a, __m256i b, __m256i& lo, __m256i& hi) {
+        __m256i greater = _mm256_cmpgt_epi64(a, b);
+        lo = _mm256_blendv_epi8(a, b, greater);
+        hi = _mm256_blendv_epi8(b, a, greater);
+    }
+
+    __attribute__((target("avx2")))
+    static __m256i partner(__m256i v, int j) {
+        if (j == 2) return _mm256_permute2x128_si256(v, v, 1);
+        return _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+    }
+
+    __attribute__((target("avx2")))
+    static __m256i bitClear(int base, int bit) {
+        __m256i idx = _mm256_add_epi64(_mm256_setr_epi64x(0, 1, 2, 3), _mm256_set1_epi64x(base));
+        return _mm256_cmpeq_epi64(_mm256_and_si256(idx, _mm256_set1_epi64x(bit)), _mm256_setzero_si256());
+    }
+
+    __attribute__((target("avx2")))
+    static __m256i reverse(__m256i v) {
+        return _mm256_permute4x64_epi64(v, _MM_SHUFFLE(0, 1, 2, 3));
+    }
+};
+
+// One merge step of the bitonic network over N = Regs * LANES elements held
+// in AVX2 registers: for each distance j < k, element i is compare-exchanged
+// with i ^ j, ascending when (i & k) == 0. With k == N this sorts a bitonic
+// sequence. Distances of a register or more pair whole registers; smaller
+// distances pair lanes of one register, brought together with a shuffle and
+// resolved with a blend.
+template <typename Lanes, int Regs>
+__attribute__((target("avx2")))
+void bitonicStageAvx2(__m256i* v, int k) {
+    constexpr int L = Lanes::LANES;
+
+    for (int j = k >> 1; j > 0; j >>= 1) {
+        if (j >= L) {
+            int jr = j / L;
+            for (int r = 0; r < Regs; r++) {
+                int p = r ^ jr;
+                if (p < r || p >= Regs) continue;
+
+                __m256i lo;
+                __m256i hi;
+                Lanes::minMax(v[r], v[p], lo, hi);
+                bool ascending = ((r * L) & k) == 0;
+                v[r] = ascending ? lo : hi;
+                v[p] = ascending ? hi : lo;
+            }
+        } else {
+            for (int r = 0; r < Regs; r++) {
+                __m256i lo;
+                __m256i hi;
+                Lanes::minMax(v[r], Lanes::partner(v[r], j), lo, hi);
+
+                // A lane keeps the minimum when it is the lower index of an
+                // ascending pair or the upper index of a descending one
+                __m256i lower = Lanes::bitClear(r * L, j);
+                __m256i ascending = Lanes::bitClear(r * L, k);
+                __m256i takeMin = _mm256_cmpeq_epi32(lower, ascending);
+
+                v[r] = _mm256_blendv_epi8(hi, lo, takeMin);
+            }
+        }
+    }
+}
+
+// Bitonic sort of Regs * 8 ints
+template <int Regs>
+__attribute__((target("avx2")))
+void bitonicAvx2(__m256i* v) {
+    for (int k = 2; k <= Regs * 8; k <<= 1) {
+        bitonicStageAvx2<Int32Lanes, Regs>(v, k);
+    }
+}
+
+template <int Regs>
+__attribute__((target("avx2")))
+void sortAvx2(int* buffer) {
+    __m256i v[Regs];
+    for (int r = 0; r < Regs; r++) {
+        v[r] = _mm256_load_si256(reinterpret_cast<const __m256i*>(buffer) + r);
+    }
+    bitonicAvx2<Regs>(v);
+    for (int r = 0; r < Regs; r++) {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(buffer) + r, v[r]);
+    }
+}
+
+// Same network with 4-lane SSE4.1 registers
+template <int Regs>
+__attribute__((target("sse4.1")))
+void bitonicSse41(__m128i* v) {
+    constexpr int N = Regs * 4;
+    const __m128i iota = _mm_setr_epi32(0, 1, 2, 3);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (int k = 2; k <= N; k <<= 1) {
+        for (int j = k >> 1; j > 0; j >>= 1) {
+            if (j >= 4) {
+                int jr = j / 4;
+                for (int r = 0; r < Regs; r++) {
+                    int p = r ^ jr;
+                    if (p < r || p >= Regs) continue;
+
+                    __m128i lo = _mm_min_epi32(v[r], v[p]);
+                    __m128i hi = _mm_max_epi32(v[r], v[p]);
+                    bool ascending = ((r * 4) & k) == 0;
+                    v[r] = ascending ? lo : hi;
+                    v[p] = ascending ? hi : lo;
+                }
+            } else {
+                for (int r = 0; r < Regs; r++) {
+                    __m128i partner;
+                    if (j == 2)
+                        partner = _mm_shuffle_epi32(v[r], _MM_SHUFFLE(1, 0, 3, 2));
+                    else
+                        partner = _mm_shuffle_epi32(v[r], _MM_SHUFFLE(2, 3, 0, 1));
+
+                    __m128i lo = _mm_min_epi32(v[r], partner);
+                    __m128i hi = _mm_max_epi32(v[r], partner);
+
+                    __m128i idx = _mm_add_epi32(iota, _mm_set1_epi32(r * 4));
+                    __m128i lower = _mm_cmpeq_epi32(_mm_and_si128(idx, _mm_set1_epi32(j)), zero);
+                    __m128i ascending = _mm_cmpeq_epi32(_mm_and_si128(idx, _mm_set1_epi32(k)), zero);
+                    __m128i takeMin = _mm_cmpeq_epi32(lower, ascending);
+
+                    v[r] = _mm_blendv_epi8(hi, lo, takeMin);
+                }
+            }
+        }
+    }
+}
+
+template <int Regs>
+__attribute__((target("sse4.1")))
+void sortSse41(int* buffer) {
+    __m128i v[Regs];
+    for (int r = 0; r < Regs; r++) {
+        v[r] = _mm_load_si128(reinterpret_cast<const __m128i*>(buffer) + r);
+    }
+    bitonicSse41<Regs>(v);
+    for (int r = 0; r < Regs; r++) {
+        _mm_store_si128(reinterpret_cast<__m128i*>(buffer) + r, v[r]);
+    }
+}
+
+// Block loads and stores of Regs registers. A block loaded reversed is
+// descending, so a sorted block followed by it forms a bitonic sequence.
+template <typename Lanes, int Regs>
+__attribute__((target("avx2")))
+void loadBlock(__m256i* v, const typename Lanes::T* src) {
+    for (int r = 0; r < Regs; r++) {
+        v[r] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + r * Lanes::LANES));
+    }
+}
+
+template <typename Lanes, int Regs>
+__attribute__((target("avx2")))
+void loadBlockReversed(__m256i* v, const typename Lanes::T* src) {
+    for (int r = 0; r < Regs; r++) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + (Regs - 1 - r) * Lanes::LANES));
+        v[r] = Lanes::reverse(block);
+    }
+}
+
+template <typename Lanes, int Regs>
+__attribute__((target("avx2")))
+void storeBlock(typename Lanes::T* dst, const __m256i* v) {
+    for (int r = 0; r < Regs; r++) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + r * Lanes::LANES), v[r]);
+    }
+}
+
+// Scalar merges for what is left after the vector loop. The forward one may
+// write over the front of b's storage and the backward one over the back of
+// a's, as long as the output never passes the element being read.
+template <typename T>
+void mergeForwardScalar(const T* a, std::ptrdiff_t na, const T* b, std::ptrdiff_t nb, T* out) {
+    std::ptrdiff_t i = 0;
+    std::ptrdiff_t j = 0;
+    while (i < na && j < nb) {
+        *out++ = b[j] < a[i] ? b[j++] : a[i++];
+    }
+    while (i < na) *out++ = a[i++];
+    if (out != b + j) {
+        while (j < nb) *out++ = b[j++];
+    }
+}
+
+template <typename T>
+void mergeBackwardScalar(const T* a, std::ptrdiff_t na, const T* b, std::ptrdiff_t nb, T* out) {
+    T* dst = out + na + nb;
+    while (na > 0 && nb > 0) {
+        *--dst = b[nb - 1] < a[na - 1] ? a[--na] : b[--nb];
+    }
+    while (nb > 0) *--dst = b[--nb];
+    if (dst != a + na) {
+        while (na > 0) *--dst = a[--na];
+    }
+}
+
+// Merge a[0, na) and b[0, nb) into out front to back, W = Regs * LANES
+// elements a step. Two blocks of W form a bitonic sequence that one network
+// stage sorts; the lower half is final and stored, the upper half is kept and
+// meets the next block from whichever input has the smaller next element.
+// Needs na, nb >= W.
+template <typename Lanes, int Regs>
+__attribute__((target("avx2")))
+void mergeForwardAvx2(const typename Lanes::T* a, std::ptrdiff_t na,
+                      const typename Lanes::T* b, std::ptrdiff_t nb, typename Lanes::T* out) {
+    using T = typename Lanes::T;
+    constexpr std::ptrdiff_t W = Regs * Lanes::LANES;
+
+    __m256i v[2 * Regs];
+    loadBlock<Lanes, Regs>(v, a);
+    loadBlockReversed<Lanes, Regs>(v + Regs, b);
+    std::ptrdiff_t ia = W;
+    std::ptrdiff_t ib = W;
+    bool takeA;
+
+    while (true) {
+        bitonicStageAvx2<Lanes, 2 * Regs>(v, static_cast<int>(2 * W));
+        storeBlock<Lanes, Regs>(out, v);
+        out += W;
+        for (int r = 0; r < Regs; r++) v[r] = v[Regs + r];
+
+        takeA = ib == nb || (ia < na && !(b[ib] < a[ia]));
+        if (takeA) {
+            if (na - ia < W) break;
+            loadBlockReversed<Lanes, Regs>(v + Regs, a + ia);
+            ia += W;
+        } else {
+            if (nb - ib < W) break;
+            loadBlockReversed<Lanes, Regs>(v + Regs, b + ib);
+            ib += W;
+        }
+    }
+
+    // Scalar tail: the kept block and the short remainder of the input that
+    // ran out merge on the stack, then that merges with the other remainder
+    T kept[W];
+    T merged[2 * W];
+    storeBlock<Lanes, Regs>(kept, v);
+    if (takeA) {
+        std::ptrdiff_t m = std::merge(kept, kept + W, a + ia, a + na, merged) - merged;
+        mergeForwardScalar(merged, m, b + ib, nb - ib, out);
+    } else {
+        std::ptrdiff_t m = std::merge(kept, kept + W, b + ib, b + nb, merged) - merged;
+        mergeForwardScalar(merged, m, a + ia, na - ia, out);
+    }
+}
+
+// The same merge back to front: the upper half of each step is final and the
+// lower half meets the previous block of whichever input has the larger
+// last element
+template <typename Lanes, int Regs>
+__attribute__((target("avx2")))
+void mergeBackwardAvx2(const typename Lanes::T* a, std::ptrdiff_t na,
+                       const typename Lanes::T* b, std::ptrdiff_t nb, typename Lanes::T* out) {
+    using T = typename Lanes::T;
+    constexpr std::ptrdiff_t W = Regs * Lanes::LANES;
+
+    __m256i v[2 * Regs];
+    loadBlock<Lanes, Regs>(v, a + na - W);
+    loadBlockReversed<Lanes, Regs>(v + Regs, b + nb - W);
+    std::ptrdiff_t ra = na - W;
+    std::ptrdiff_t rb = nb - W;
+    T* dst = out + na + nb;
+    bool takeA;
+
+    while (true) {
+        bitonicStageAvx2<Lanes, 2 * Regs>(v, static_cast<int>(2 * W));
+        dst -= W;
+        storeBlock<Lanes, Regs>(dst, v + Regs);
+
+        takeA = rb == 0 || (ra > 0 && b[rb - 1] < a[ra - 1]);
+        if (takeA) {
+            if (ra < W) break;
+            ra -= W;
+            loadBlockReversed<Lanes, Regs>(v + Regs, a + ra);
+        } else {
+            if (rb < W) break;
+            rb -= W;
+            loadBlockReversed<Lanes, Regs>(v + Regs, b + rb);
+        }
+    }
+
+    T kept[W];
+    T merged[2 * W];
+    storeBlock<Lanes, Regs>(kept, v);
+    if (takeA) {
+        std::ptrdiff_t m = std::merge(a, a + ra, kept, kept + W, merged) - merged;
+        mergeBackwardScalar(b, rb, merged, m, out);
+    } else {
+        std::ptrdiff_t m = std::merge(b, b + rb, kept, kept + W, merged) - merged;
+        mergeBackwardScalar(a, ra, merged, m, out);
+    }
+}
+
+// Runs of at least 16 on both sides merge 16 lanes a step, shorter ones 8
+template <typename Lanes, bool Backward>
+bool mergeAvx2(const typename Lanes::T* a, std::ptrdiff_t na,
+               const typename Lanes::T* b, std::ptrdiff_t nb, typename Lanes::T* out) {
+    constexpr std::ptrdiff_t W = Lanes::LANES;
+    if (activeIsa() != IsaLevel::AVX2 || na < W || nb < W) return false;
+
+    if (na >= 2 * W && nb >= 2 * W) {
+        if (Backward)
+            mergeBackwardAvx2<Lanes, 2>(a, na, b, nb, out);
+        else
+            mergeForwardAvx2<Lanes, 2>(a, na, b, nb, out);
+    } else {
+        if (Backward)
+            mergeBackwardAvx2<Lanes, 1>(a, na, b, nb, out);
+        else
+            mergeForwardAvx2<Lanes, 1>(a, na, b, nb, out);
+    }
+    return true;
+}
+
+} // namespace
+
+bool sortNetwork(int* data, std::ptrdiff_t n) {
+    IsaLevel isa = activeIsa();
+    if (n > MAX_NETWORK_SIZE || isa == IsaLevel::SCALAR) return false;
+    if (n < 2) return true;
+
+    // Pad to the kernel size with INT_MAX, which sorts to the unused tail
+    std::ptrdiff_t size = 8;
+    while (size < n) size <<= 1;
+
+    alignas(32) int buffer[MAX_NETWORK_SIZE];
+    std::copy(data, data + n, buffer);
+    std::fill(buffer + n, buffer + size, INT_MAX);
+
+    if (isa == IsaLevel::AVX2) {
+        switch (size) {
+            case 8: sortAvx2<1>(buffer); break;
+            case 16: sortAvx2<2>(buffer); break;
+            case 32: sortAvx2<4>(buffer); break;
+            default: sortAvx2<8>(buffer); break;
+        }
+    } else {
+        switch (size) {
+            case 8: sortSse41<2>(buffer); break;
+            case 16: sortSse41<4>(buffer); break;
+            case 32: sortSse41<8>(buffer); break;
+            default: sortSse41<16>(buffer); break;
+        }
+    }
+
+    std::copy(buffer, buffer + n, data);
+    return true;
+}
+
+bool mergeInts(const int* a, std::ptrdiff_t na, const int* b, std::ptrdiff_t nb, int* out) {
+    return mergeAvx2<Int32Lanes, false>(a, na, b, nb, out);
+}
+
+bool mergeIntsBackward(const int* a, std::ptrdiff_t na, const int* b, std::ptrdiff_t nb, int* out) {
+    return mergeAvx2<Int32Lanes, true>(a, na, b, nb, out);
+}
+
+bool mergeKeyIndex(const std::int64_t* a, std::ptrdiff_t na, const std::int64_t* b, std::ptrdiff_t nb,
+                   std::int64_t* out) {
+    return mergeAvx2<Int64Lanes, false>(a, na, b, nb, out);
+}
+
+#else
+
+bool sortNetwork(int*, std::ptrdiff_t) {
+    return false;
+}
+
+bool mergeInts(const int*, std::ptrdiff_t, const int*, std::ptrdiff_t, int*) {
+    return false;
+}
+
+bool mergeIntsBackward(const int*, std::ptrdiff_t, const int*, std::ptrdiff_t, int*) {
+    return false;
+}
+
+bool mergeKeyIndex(const std::int64_t*, std::ptrdiff_t, const std::int64_t*, std::ptrdiff_t, std::int64_t*) {
+    return false;
+}
+
+#endif
+
+} // namespace simd
+} // namespace sorting
@@ -0,0 +1,132 @@
+#include "../include/thread_pool.h"
+
+namespace {
+
+// Pool and queue index of the worker running on this thread, if any
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local std::size_t currentIndex = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(std::size_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+        if (threadCount == 0) threadCount = 1;
+    }
+
+    for (std::size_t i = 0; i <= threadCount; i++) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+
+    workers.reserve(threadCount);
+    for (std::size_t i = 0; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i + 1);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping.store(true);
+    }
+    wakeUp.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+std::size_t ThreadPool::currentQueue() const {
+    return currentPool == this ? currentIndex : 0;
+}
+
+void ThreadPool::submit(Task task) {
+    {
+        // Count the task before it becomes visible so the counter never underflows.
+        // Taking the lock orders the increment before a sleeping worker's predicate check.
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        queuedTasks.fetch_add(1);
+    }
+
+    WorkQueue& queue = *queues[currentQueue()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    wakeUp.notify_one();
+}
+
+bool ThreadPool::popLocal(std::size_t queue, Task& task) {
+    WorkQueue& q = *queues[queue];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.tasks.empty()) return false;
+
+    // The injection queue is FIFO, worker deques are LIFO for their owner
+    if (queue == 0) {
+        task = std::move(q.tasks.front());
+        q.tasks.pop_front();
+    } else {
+        task = std::move(q.tasks.back());
+        q.tasks.pop_back();
+    }
+    return true;
+}
+
+bool ThreadPool::steal(std::size_t thief, Task& task) {
+    std::size_t count = queues.size();
+    for (std::size_t offset = 1; offset < count; offset++) {
+        WorkQueue& q = *queues[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (!q.tasks.empty()) {
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::runPendingTask() {
+    std::size_t self = currentQueue();
+
+    Task task;
+    if (!popLocal(self, task) && !steal(self, task)) {
+        return false;
+    }
+
+    queuedTasks.fetch_sub(1);
+    task();
+    return true;
+}
+
+void ThreadPool::workerLoop(std::size_t index) {
+    currentPool = this;
+    currentIndex = index;
+
+    while (true) {
+        if (runPendingTask()) continue;
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeUp.wait(lock, [this] { return stopping.load() || queuedTasks.load() > 0; });
+        if (stopping.load() && queuedTasks.load() == 0) return;
+    }
+}
+
+void TaskGroup::drain() {
+    while (pending.load(std::memory_order_acquire) > 0) {
+        if (!pool.runPendingTask()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void TaskGroup::wait() {
+    drain();
+
+    std::lock_guard<std::mutex> lock(errorMutex);
+    if (error) {
+        std::exception_ptr e = error;
+        error = nullptr;
+        std::rethrow_exception(e);
+    }
+}
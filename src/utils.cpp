@@ -1,10 +1,19 @@
 #include "../include/utils.h"
+#include "../include/benchmark.h"
+#include "../include/random_stream.h"
+#include "../include/sort_algorithms.h"
 #include <algorithm>
+#include <climits>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
 #include <random>
 #include <iostream>
 #include <fstream>
 #include <iomanip>
 #include <chrono>
+#include <cstdio>
+#include <sstream>
 
 // Platform-specific memory usage tracking
 #ifdef _WIN32
@@ -17,16 +26,27 @@
 #include <unistd.h>
 #endif
 
-std::vector<int> generateRandomData(size_t size, int min, int max) {
-    std::vector<int> data(size);
+std::uint64_t randomSeed() {
     std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> distrib(min, max);
-    
-    for (size_t i = 0; i < size; i++) {
-        data[i] = distrib(gen);
+    return (static_cast<std::uint64_t>(rd()) << 32) | rd();
+}
+
+std::vector<int> generateRandomData(size_t size, int min, int max) {
+    return generateRandomData(size, min, max, randomSeed());
+}
+
+std::vector<int> generateRandomData(size_t size, int min, int max, std::uint64_t seed) {
+    if (min > max) {
+        throw std::invalid_argument("random data needs min <= max");
     }
-    
+
+    std::vector<int> data(size);
+    std::uint64_t range = static_cast<std::uint64_t>(static_cast<std::int64_t>(max) - min) + 1;
+    fillRandomBlocks(data, seed, [min, range](Xoshiro256& gen, int* first, int* last) {
+        for (int* value = first; value != last; ++value) {
+            *value = static_cast<int>(static_cast<std::int64_t>(min) + static_cast<std::int64_t>(gen.below(range)));
+        }
+    });
     return data;
 }
 
@@ -47,6 +67,10 @@ std::vector<int> generateSortedData(size_t size, bool ascending) {
 }
 
 std::vector<int> generatePartiallySortedData(size_t size, double sortedRatio) {
+    return generatePartiallySortedData(size, sortedRatio, randomSeed());
+}
+
+std::vector<int> generatePartiallySortedData(size_t size, double sortedRatio, std::uint64_t seed) {
     // Generate sorted data first
     std::vector<int> data = generateSortedData(size, true);
     
@@ -54,19 +78,205 @@ std::vector<int> generatePartiallySortedData(size_t size, double sortedRatio) {
     size_t shuffleCount = static_cast<size_t>(size * (1.0 - sortedRatio));
     
     // Create random number generator
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    Xoshiro256 gen(seed);
     
     // Shuffle a portion of the data
     for (size_t i = 0; i < shuffleCount; i++) {
-        size_t idx1 = std::uniform_int_distribution<size_t>(0, size - 1)(gen);
-        size_t idx2 = std::uniform_int_distribution<size_t>(0, size - 1)(gen);
+        size_t idx1 = static_cast<size_t>(gen.below(size));
+        size_t idx2 = static_cast<size_t>(gen.below(size));
         std::swap(data[idx1], data[idx2]);
     }
     
     return data;
 }
 
+std::vector<int> generateUniformData(size_t size, std::uint64_t seed) {
+    return generateRandomData(size, INT_MIN, INT_MAX, seed);
+}
+
+// Zipf ranks by rejection-inversion (Hörmann and Derflinger, "Rejection-
+// inversion to generate variates from monotone discrete distributions"),
+// which needs no table of the size probabilities
+class ZipfSampler {
+public:
+    ZipfSampler(std::uint64_t count, double exponent)
+        : count(count), exponent(exponent),
+          integralX1(integral(1.5) - 1.0),
+          integralCount(integral(static_cast<double>(count) + 0.5)),
+          squeeze(2.0 - integralInverse(integral(2.5) - density(2.0))) {}
+
+    // Rank in [1, count]
+    std::uint64_t operator()(Xoshiro256& gen) const {
+        while (true) {
+            double u = integralCount + gen.uniform() * (integralX1 - integralCount);
+            double x = integralInverse(u);
+            double k = std::floor(x + 0.5);
+            k = std::min(std::max(k, 1.0), static_cast<double>(count));
+            if (k - x <= squeeze || u >= integral(k + 0.5) - density(k)) {
+                return static_cast<std::uint64_t>(k);
+            }
+        }
+    }
+
+private:
+    std::uint64_t count;
+    double exponent;
+    double integralX1;
+    double integralCount;
+    double squeeze;
+
+    double density(double x) const {
+        return std::exp(-exponent * std::log(x));
+    }
+
+    double integral(double x) const {
+        double logX = std::log(x);
+        return expm1OverX((1.0 - exponent) * logX) * logX;
+    }
+
+    double integralInverse(double x) const {
+        double t = std::max(x * (1.0 - exponent), -1.0);
+        return std::exp(log1pOverX(t) * x);
+    }
+
+    // log(1 + x) / x and (e^x - 1) / x, with series near 0
+    static double log1pOverX(double x) {
+        return std::fabs(x) > 1e-8 ? std::log1p(x) / x : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+    }
+
+    static double expm1OverX(double x) {
+        return std::fabs(x) > 1e-8 ? std::expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x / 3.0 * (1.0 + 0.25 * x));
+    }
+};
+
+// A bijection of 32-bit values (the murmur3 finalizer)
+static std::uint32_t mix32(std::uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x85EBCA6BU;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35U;
+    x ^= x >> 16;
+    return x;
+}
+
+std::vector<int> generateZipfData(size_t size, double exponent, std::uint64_t seed) {
+    if (!(exponent >= 0.0)) {
+        throw std::invalid_argument("Zipf exponent must be non-negative");
+    }
+
+    // Ranks are mixed into keys spread over the int range, so the frequent
+    // keys are not all small; mix32 keeps distinct ranks distinct
+    std::vector<int> data(size);
+    ZipfSampler sampler(std::max<size_t>(size, 1), exponent);
+    std::uint32_t salt = static_cast<std::uint32_t>(seed >> 32);
+    fillRandomBlocks(data, seed, [&sampler, salt](Xoshiro256& gen, int* first, int* last) {
+        for (int* value = first; value != last; ++value) {
+            *value = static_cast<int>(mix32(static_cast<std::uint32_t>(sampler(gen)) ^ salt));
+        }
+    });
+    return data;
+}
+
+std::vector<int> generateFewUniquesData(size_t size, size_t uniqueKeys, std::uint64_t seed) {
+    if (uniqueKeys == 0 || uniqueKeys > size_t(1) << 32) {
+        throw std::invalid_argument("few-uniques data needs between 1 and 2^32 keys");
+    }
+
+    // The keys come from a stream of their own (seed + 1)
+    std::vector<int> keys = generateUniformData(uniqueKeys, seed + 1);
+
+    std::vector<int> data(size);
+    fillRandomBlocks(data, seed, [&keys](Xoshiro256& gen, int* first, int* last) {
+        for (int* value = first; value != last; ++value) {
+            *value = keys[gen.below(keys.size())];
+        }
+    });
+    return data;
+}
+
+std::vector<int> generateAllEqualData(size_t size) {
+    return std::vector<int>(size, 42);
+}
+
+std::vector<int> generateOrganPipeData(size_t size) {
+    std::vector<int> data(size);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = static_cast<int>(std::min(i, size - 1 - i));
+    }
+    return data;
+}
+
+std::vector<int> generateSawtoothData(size_t size, size_t period) {
+    if (period == 0) {
+        throw std::invalid_argument("sawtooth period must be positive");
+    }
+
+    std::vector<int> data(size);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = static_cast<int>(i % period);
+    }
+    return data;
+}
+
+std::vector<int> generateRandomRunsData(size_t size, size_t runLength, std::uint64_t seed) {
+    if (runLength == 0) {
+        throw std::invalid_argument("run length must be positive");
+    }
+
+    std::vector<int> data = generateUniformData(size, seed);
+    for (size_t start = 0; start < size; start += runLength) {
+        std::sort(data.begin() + start, data.begin() + std::min(size, start + runLength));
+    }
+    return data;
+}
+
+std::vector<int> generateSortedTailData(size_t size, double tailRatio, std::uint64_t seed) {
+    if (!(tailRatio >= 0.0 && tailRatio <= 1.0)) {
+        throw std::invalid_argument("tail ratio must be between 0 and 1");
+    }
+
+    // The tail draws from the same range as the sorted head
+    size_t tail = static_cast<size_t>(static_cast<double>(size) * tailRatio);
+    std::vector<int> data = generateSortedData(size - tail, true);
+    std::vector<int> randomTail = generateRandomData(tail, 0, static_cast<int>(std::max<size_t>(size, 1) - 1), seed);
+    data.insert(data.end(), randomTail.begin(), randomTail.end());
+    return data;
+}
+
+std::vector<int> generateQuicksortKillerData(size_t size) {
+    // Values start out as "gas", above every solid value, and are frozen to
+    // the next solid value when the sort needs them ordered. When two gas
+    // values meet, the one that is not the likely pivot is frozen, so the
+    // pivot ends up larger than everything it was compared with.
+    const int gas = static_cast<int>(size);
+    std::vector<int> values(size, gas);
+    std::vector<int> order(size);
+    std::iota(order.begin(), order.end(), 0);
+
+    int solid = 0;
+    int candidate = 0;
+    sorting::quickSort(order.begin(), order.end(), [&](int a, int b) {
+        if (values[a] == gas && values[b] == gas) {
+            values[a == candidate ? a : b] = solid++;
+        }
+        if (values[a] == gas) {
+            candidate = a;
+        } else if (values[b] == gas) {
+            candidate = b;
+        }
+        return values[a] < values[b];
+    });
+
+    // Remaining gas values were never compared with each other, so any order
+    // among them is consistent; this makes the result a permutation
+    for (int& value : values) {
+        if (value == gas) {
+            value = solid++;
+        }
+    }
+    return values;
+}
+
 bool isSorted(const std::vector<int>& arr, bool ascending) {
     if (arr.empty() || arr.size() == 1) {
         return true;
@@ -111,41 +321,317 @@ size_t getCurrentMemoryUsage() {
     return 0; // Return 0 if failed to get memory usage
 }
 
+const std::vector<DataSetType>& allDataSetTypes() {
+    static const std::vector<DataSetType> types = {
+        DataSetType::RANDOM,
+        DataSetType::SORTED_ASC,
+        DataSetType::SORTED_DESC,
+        DataSetType::PARTIALLY_SORTED,
+        DataSetType::UNIFORM,
+        DataSetType::ZIPF,
+        DataSetType::FEW_UNIQUES,
+        DataSetType::ALL_EQUAL,
+        DataSetType::ORGAN_PIPE,
+        DataSetType::SAWTOOTH,
+        DataSetType::RANDOM_RUNS,
+        DataSetType::SORTED_TAIL,
+        DataSetType::QUICKSORT_KILLER
+    };
+    return types;
+}
+
+std::string dataSetName(DataSetType type) {
+    switch (type) {
+        case DataSetType::RANDOM: return "Random";
+        case DataSetType::SORTED_ASC: return "Sorted (Asc)";
+        case DataSetType::SORTED_DESC: return "Sorted (Desc)";
+        case DataSetType::PARTIALLY_SORTED: return "Partially Sorted";
+        case DataSetType::UNIFORM: return "Uniform";
+        case DataSetType::ZIPF: return "Zipf";
+        case DataSetType::FEW_UNIQUES: return "Few Uniques";
+        case DataSetType::ALL_EQUAL: return "All Equal";
+        case DataSetType::ORGAN_PIPE: return "Organ Pipe";
+        case DataSetType::SAWTOOTH: return "Sawtooth";
+        case DataSetType::RANDOM_RUNS: return "Random Runs";
+        case DataSetType::SORTED_TAIL: return "Sorted + Tail";
+        case DataSetType::QUICKSORT_KILLER: return "Quicksort Killer";
+        default: return "Unknown";
+    }
+}
+
+std::string dataSetKey(DataSetType type) {
+    switch (type) {
+        case DataSetType::RANDOM: return "random";
+        case DataSetType::SORTED_ASC: return "sorted-asc";
+        case DataSetType::SORTED_DESC: return "sorted-desc";
+        case DataSetType::PARTIALLY_SORTED: return "partial";
+        case DataSetType::UNIFORM: return "uniform";
+        case DataSetType::ZIPF: return "zipf";
+        case DataSetType::FEW_UNIQUES: return "few-uniques";
+        case DataSetType::ALL_EQUAL: return "all-equal";
+        case DataSetType::ORGAN_PIPE: return "organ-pipe";
+        case DataSetType::SAWTOOTH: return "sawtooth";
+        case DataSetType::RANDOM_RUNS: return "runs";
+        case DataSetType::SORTED_TAIL: return "sorted-tail";
+        case DataSetType::QUICKSORT_KILLER: return "qsort-killer";
+        default: return "unknown";
+    }
+}
+
 std::vector<int> generateDataSet(DataSetType type, size_t size) {
+    return generateDataSet(type, size, randomSeed());
+}
+
+std::vector<int> generateDataSet(DataSetType type, size_t size, std::uint64_t seed) {
+    return generateDataSet(type, size, seed, DataSetParams());
+}
+
+std::vector<int> generateDataSet(DataSetType type, size_t size, std::uint64_t seed,
+                                 const DataSetParams& params) {
     switch (type) {
         case DataSetType::RANDOM:
-            return generateRandomData(size);
+            return generateRandomData(size, 0, 1000, seed);
         case DataSetType::SORTED_ASC:
             return generateSortedData(size, true);
         case DataSetType::SORTED_DESC:
             return generateSortedData(size, false);
         case DataSetType::PARTIALLY_SORTED:
-            return generatePartiallySortedData(size);
+            return generatePartiallySortedData(size, 0.7, seed);
+        case DataSetType::UNIFORM:
+            return generateUniformData(size, seed);
+        case DataSetType::ZIPF:
+            return generateZipfData(size, params.zipfExponent, seed);
+        case DataSetType::FEW_UNIQUES:
+            return generateFewUniquesData(size, params.uniqueKeys, seed);
+        case DataSetType::ALL_EQUAL:
+            return generateAllEqualData(size);
+        case DataSetType::ORGAN_PIPE:
+            return generateOrganPipeData(size);
+        case DataSetType::SAWTOOTH:
+            return generateSawtoothData(size, params.runLength);
+        case DataSetType::RANDOM_RUNS:
+            return generateRandomRunsData(size, params.runLength, seed);
+        case DataSetType::SORTED_TAIL:
+            return generateSortedTailData(size, params.tailRatio, seed);
+        case DataSetType::QUICKSORT_KILLER:
+            return generateQuicksortKillerData(size);
         default:
-            return generateRandomData(size);
+            return generateRandomData(size, 0, 1000, seed);
+    }
+}
+
+std::string resultLabel(const SortingResult& result) {
+    if (result.dataSetName.empty()) {
+        return result.algorithmName;
     }
+    return result.algorithmName + " [" + result.dataSetName + ", n=" + std::to_string(result.dataSize) + "]";
 }
 
 void printResults(const std::vector<SortingResult>& results) {
     // Print header
     std::cout << std::left << std::setw(20) << "Algorithm"
               << std::setw(15) << "Time (ms)"
+              << std::setw(15) << "Stddev (ms)"
               << std::setw(20) << "Memory (bytes)"
               << std::setw(10) << "Stable"
               << std::setw(10) << "Sorted" << std::endl;
     
-    std::cout << std::string(75, '-') << std::endl;
+    std::cout << std::string(90, '-') << std::endl;
     
     // Print results
     for (const auto& result : results) {
-        std::cout << std::left << std::setw(20) << result.algorithmName
+        std::cout << std::left << std::setw(20) << resultLabel(result)
                   << std::fixed << std::setprecision(4) << std::setw(15) << result.executionTimeMs
+                  << std::setw(15) << result.timing.stddevMs
                   << std::setw(20) << result.memoryUsageBytes
                   << std::setw(10) << (result.isStable ? "Yes" : "No")
                   << std::setw(10) << (result.isSorted ? "Yes" : "No") << std::endl;
     }
 }
 
+// A CSV field, quoted when it holds a separator, quote or line break
+static std::string csvField(const std::string& value) {
+    if (value.find_first_of(",\"\r\n") == std::string::npos) {
+        return value;
+    }
+    std::string quoted = "\"";
+    for (char c : value) {
+        quoted += c;
+        if (c == '"') {
+            quoted += '"';
+        }
+    }
+    return quoted + "\"";
+}
+
+void writeResultsCSV(std::ostream& out, const std::vector<SortingResult>& results, bool header) {
+    // Write CSV header
+    if (header) {
+        out << "Algorithm,Distribution,N,Seed,Threads,Time (ms),Memory (bytes),Stable,Sorted,"
+            << "Min (ms),P90 (ms),P99 (ms),Stddev (ms),Samples,Outliers,Allocated (bytes),Allocations,"
+            << "Cycles,Instructions,IPC,Branch misses/elem,L1D misses/elem,LLC misses/elem,dTLB misses/elem,"
+            << "Comparisons,Swaps,Moves\n";
+    }
+    
+    // Write results; the data set columns are empty when not recorded
+    for (const auto& result : results) {
+        bool hasDataSet = !result.dataSetName.empty();
+        out << csvField(result.algorithmName) << ","
+            << csvField(result.dataSetName) << ","
+            << (hasDataSet ? std::to_string(result.dataSize) : "") << ","
+            << (result.hasDataSeed ? std::to_string(result.dataSeed) : "") << ","
+            << result.threads << ","
+            << std::fixed << std::setprecision(4) << result.executionTimeMs << ","
+            << result.memoryUsageBytes << ","
+            << (result.isStable ? "Yes" : "No") << ","
+            << (result.isSorted ? "Yes" : "No") << ","
+            << result.timing.minMs << ","
+            << result.timing.p90Ms << ","
+            << result.timing.p99Ms << ","
+            << result.timing.stddevMs << ","
+            << result.timing.samples << ","
+            << result.timing.outliers << ","
+            << result.allocations.bytesAllocated << ","
+            << result.allocations.allocationCount;
+        
+        // Missing counters are left empty
+        const PerfCounts& counters = result.counters;
+        double values[] = {
+            counters.cycles,
+            counters.instructions,
+            counters.ipc(),
+            PerfCounts::perElement(counters.branchMisses, result.dataSize),
+            PerfCounts::perElement(counters.l1dMisses, result.dataSize),
+            PerfCounts::perElement(counters.llcMisses, result.dataSize),
+            PerfCounts::perElement(counters.dtlbMisses, result.dataSize)
+        };
+        for (double value : values) {
+            out << ",";
+            if (value >= 0.0) {
+                out << value;
+            }
+        }
+        
+        // So are the operation counts of algorithms that are not counted
+        const OperationCounts& operations = result.operations;
+        if (operations.counted) {
+            out << "," << operations.comparisons << "," << operations.swaps << "," << operations.moves;
+        } else {
+            out << ",,,";
+        }
+        out << "\n";
+    }
+}
+
+// Quote a string for JSON output
+static std::string jsonString(const std::string& value) {
+    std::string quoted = "\"";
+    for (char c : value) {
+        switch (c) {
+            case '"': quoted += "\\\""; break;
+            case '\\': quoted += "\\\\"; break;
+            case '\n': quoted += "\\n"; break;
+            case '\t': quoted += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                    quoted += escaped;
+                } else {
+                    quoted += c;
+                }
+        }
+    }
+    return quoted + "\"";
+}
+
+// A counter value for JSON output; missing counters are null
+static std::string jsonNumber(double value) {
+    if (value < 0.0) {
+        return "null";
+    }
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(6) << value;
+    return text.str();
+}
+
+// An operation count, or null when the algorithm was not counted
+static std::string jsonCount(const OperationCounts& operations, unsigned long long count) {
+    return operations.counted ? std::to_string(count) : "null";
+}
+
+// The fields of one result as JSON members, without the enclosing braces
+static void writeResultFields(std::ostream& out, const SortingResult& result) {
+    out << "\"algorithm\": " << jsonString(result.algorithmName)
+        << ", \"distribution\": " << jsonString(result.dataSetName)
+        << ", \"n\": " << result.dataSize
+        << ", \"seed\": " << (result.hasDataSeed ? std::to_string(result.dataSeed) : "null")
+        << ", \"threads\": " << result.threads
+        << ", \"timeMs\": " << std::fixed << std::setprecision(6) << result.executionTimeMs
+        << ", \"minMs\": " << result.timing.minMs
+        << ", \"meanMs\": " << result.timing.meanMs
+        << ", \"p90Ms\": " << result.timing.p90Ms
+        << ", \"p99Ms\": " << result.timing.p99Ms
+        << ", \"stddevMs\": " << result.timing.stddevMs
+        << ", \"samples\": " << result.timing.samples
+        << ", \"outliers\": " << result.timing.outliers
+        << ", \"sortsPerSample\": " << result.timing.sortsPerSample
+        << ", \"cycles\": " << jsonNumber(result.counters.cycles)
+        << ", \"instructions\": " << jsonNumber(result.counters.instructions)
+        << ", \"ipc\": " << jsonNumber(result.counters.ipc())
+        << ", \"branchMisses\": " << jsonNumber(result.counters.branchMisses)
+        << ", \"l1dMisses\": " << jsonNumber(result.counters.l1dMisses)
+        << ", \"llcMisses\": " << jsonNumber(result.counters.llcMisses)
+        << ", \"dtlbMisses\": " << jsonNumber(result.counters.dtlbMisses)
+        << ", \"branchMissesPerElement\": "
+        << jsonNumber(PerfCounts::perElement(result.counters.branchMisses, result.dataSize))
+        << ", \"l1dMissesPerElement\": "
+        << jsonNumber(PerfCounts::perElement(result.counters.l1dMisses, result.dataSize))
+        << ", \"llcMissesPerElement\": "
+        << jsonNumber(PerfCounts::perElement(result.counters.llcMisses, result.dataSize))
+        << ", \"dtlbMissesPerElement\": "
+        << jsonNumber(PerfCounts::perElement(result.counters.dtlbMisses, result.dataSize))
+        << ", \"comparisons\": " << jsonCount(result.operations, result.operations.comparisons)
+        << ", \"swaps\": " << jsonCount(result.operations, result.operations.swaps)
+        << ", \"moves\": " << jsonCount(result.operations, result.operations.moves)
+        << ", \"memoryBytes\": " << result.memoryUsageBytes
+        << ", \"bytesAllocated\": " << result.allocations.bytesAllocated
+        << ", \"peakLiveBytes\": " << result.allocations.peakLiveBytes
+        << ", \"allocations\": " << result.allocations.allocationCount
+        << ", \"stable\": " << (result.isStable ? "true" : "false")
+        << ", \"sorted\": " << (result.isSorted ? "true" : "false");
+}
+
+void writeResultsJSON(std::ostream& out, const std::vector<SortingResult>& results) {
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        out << "  {";
+        writeResultFields(out, results[i]);
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+void writeResultsJSONLines(std::ostream& out, const std::vector<SortingResult>& results,
+                           const RunMetadata& metadata) {
+    // The run's metadata is repeated on every line, so each row stands alone
+    std::ostringstream prefix;
+    prefix << "\"timestamp\": " << jsonString(metadata.timestamp)
+           << ", \"host\": " << jsonString(metadata.host)
+           << ", \"cpu\": " << jsonString(metadata.cpuModel)
+           << ", \"logicalCpus\": " << metadata.logicalCpus
+           << ", \"isa\": " << jsonString(metadata.isa)
+           << ", \"compiler\": " << jsonString(metadata.compiler)
+           << ", \"buildFlags\": " << jsonString(metadata.buildFlags)
+           << ", \"gitHash\": " << jsonString(metadata.gitHash) << ", ";
+
+    for (const SortingResult& result : results) {
+        out << "{" << prefix.str();
+        writeResultFields(out, result);
+        out << "}\n";
+    }
+}
+
 void saveResultsToCSV(const std::vector<SortingResult>& results, const std::string& filename) {
     std::ofstream file(filename);
     
@@ -154,17 +640,7 @@ void saveResultsToCSV(const std::vector<SortingResult>& results, const std::stri
         return;
     }
     
-    // Write CSV header
-    file << "Algorithm,Time (ms),Memory (bytes),Stable,Sorted\n";
-    
-    // Write results
-    for (const auto& result : results) {
-        file << result.algorithmName << ","
-             << std::fixed << std::setprecision(4) << result.executionTimeMs << ","
-             << result.memoryUsageBytes << ","
-             << (result.isStable ? "Yes" : "No") << ","
-             << (result.isSorted ? "Yes" : "No") << "\n";
-    }
+    writeResultsCSV(file, results);
     
     file.close();
     std::cout << "Results saved to " << filename << std::endl;
@@ -176,12 +652,13 @@ std::vector<SortingResult> runAllAlgorithms(
 ) {
     std::vector<SortingResult> results;
     
+    // Every algorithm sorts its copy of the data in the same buffer
+    BenchmarkBuffer buffer;
+    BenchmarkConfig config;
+    
     for (auto algorithm : algorithms) {
-        // Make a copy of the original data
-        std::vector<int> dataCopy = data;
-        
         // Run benchmark
-        SortingResult result = runSortingBenchmark(*algorithm, dataCopy);
+        SortingResult result = runSortingBenchmark(*algorithm, data.data(), data.size(), config, buffer);
         results.push_back(result);
     }
     
@@ -196,88 +673,30 @@ std::vector<SortingResult> runAlgorithmOnAllDataSets(
     std::vector<SortingResult> results;
     
     // Data set types
-    std::vector<DataSetType> dataSetTypes = {
-        DataSetType::RANDOM,
-        DataSetType::SORTED_ASC,
-        DataSetType::SORTED_DESC,
-        DataSetType::PARTIALLY_SORTED
-    };
+    const std::vector<DataSetType>& dataSetTypes = allDataSetTypes();
     
-    std::vector<std::string> dataSetNames = {
-        "Random",
-        "Sorted (Asc)",
-        "Sorted (Desc)",
-        "Partially Sorted"
-    };
+    BenchmarkConfig config;
+    config.samples = numRuns;
+    BenchmarkBuffer buffer;
     
     // For each size
     for (size_t size : sizes) {
         // For each data set type
-        for (size_t i = 0; i < dataSetTypes.size(); i++) {
-            double totalTimeMs = 0.0;
-            size_t totalMemory = 0;
+        for (DataSetType type : dataSetTypes) {
+            // Generate data
+            std::uint64_t seed = randomSeed();
+            std::vector<int> data = generateDataSet(type, size, seed);
             
-            // Run multiple times to get average
-            for (int run = 0; run < numRuns; run++) {
-                // Generate data
-                std::vector<int> data = generateDataSet(dataSetTypes[i], size);
-                
-                // Run benchmark
-                SortingResult result = runSortingBenchmark(algorithm, data);
-                totalTimeMs += result.executionTimeMs;
-                totalMemory += result.memoryUsageBytes;
-            }
+            // Run benchmark
+            SortingResult result = runSortingBenchmark(algorithm, data.data(), data.size(), config, buffer);
+            result.dataSetName = dataSetName(type);
+            result.dataSize = size;
+            result.dataSeed = seed;
+            result.hasDataSeed = true;
             
-            // Calculate average results
-            SortingResult avgResult;
-            avgResult.algorithmName = algorithm.getName() + " [" + dataSetNames[i] + ", n=" + std::to_string(size) + "]";
-            avgResult.executionTimeMs = totalTimeMs / numRuns;
-            avgResult.memoryUsageBytes = totalMemory / numRuns;
-            avgResult.isStable = algorithm.isStable();
-            avgResult.isSorted = true; // Assuming all runs sorted correctly
-            
-            results.push_back(avgResult);
+            results.push_back(result);
         }
     }
     
     return results;
 }
-
-SortingResult runSortingBenchmark(
-    SortingAlgorithm& algorithm, 
-    const std::vector<int>& originalData,
-    bool checkSorted
-) {
-    // Create result structure
-    SortingResult result;
-    result.algorithmName = algorithm.getName();
-    result.isStable = algorithm.isStable();
-    
-    // Make a copy of the data to not modify the original
-    std::vector<int> data = originalData;
-    
-    // Measure memory before sorting
-    size_t memoryBefore = getCurrentMemoryUsage();
-    
-    // Measure time
-    auto start = std::chrono::high_resolution_clock::now();
-    
-    // Perform the sort
-    algorithm.sort(data);
-    
-    // End time measurement
-    auto end = std::chrono::high_resolution_clock::now();
-    
-    // Calculate duration in milliseconds
-    std::chrono::duration<double, std::milli> duration = end - start;
-    result.executionTimeMs = duration.count();
-    
-    // Measure memory after sorting
-    size_t memoryAfter = getCurrentMemoryUsage();
-    result.memoryUsageBytes = (memoryAfter > memoryBefore) ? (memoryAfter - memoryBefore) : 0;
-    
-    // Check if array is sorted correctly
-    result.isSorted = checkSorted ? isSorted(data) : true;
-    
-    return result;
-}
\ No newline at end of file
@@ -0,0 +1,520 @@
+#include "../include/loser_tree.h"
+#include "../include/parallel_sort.h"
+#include "../include/radix_sort.h"
+#include "../include/simd_sort.h"
+#include "../include/sort_algorithms.h"
+#include "../include/thread_pool.h"
+#include "../include/utils.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Tests for the templated sorts in sort_algorithms.h, radix_sort.h and
+// parallel_sort.h, the k-way merge in loser_tree.h and the SIMD kernels,
+// the last at every instruction set level the CPU has.
+// Every sort is checked against std::sort on the generated data sets and on
+// edge sizes; the stable ones also on keys that carry their input position.
+// Prints each failure and exits non-zero if there was any.
+
+namespace {
+
+int failures = 0;
+int checks = 0;
+
+void check(bool ok, const std::string& what) {
+    checks++;
+    if (!ok) {
+        failures++;
+        std::cerr << "FAIL: " << what << "\n";
+    }
+}
+
+// Sizes around the small-sort cutoffs and the 8/16/32/64-lane networks
+const std::vector<size_t> EDGE_SIZES = {0, 1, 2, 31, 32, 33, 64, 65};
+
+// Input sizes for the data set checks: quadratic sorts get the small one,
+// the rest a size above the parallel grain and the heap alignment threshold
+constexpr size_t QUADRATIC_SIZE = 600;
+constexpr size_t LARGE_SIZE = 20000;
+
+// A key with the position it had in the input; ordered by key only
+struct Record {
+    int key;
+    int index;
+};
+
+struct ByKey {
+    bool operator()(const Record& a, const Record& b) const { return a.key < b.key; }
+};
+
+struct ByKeyDescending {
+    bool operator()(const Record& a, const Record& b) const { return a.key > b.key; }
+};
+
+// Strings ordered by their first letter only; the rest records the position
+struct ByFirstLetter {
+    bool operator()(const std::string& a, const std::string& b) const { return a[0] < b[0]; }
+};
+
+std::vector<int> randomKeys(size_t n, int range, std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int> dist(0, range - 1);
+    std::vector<int> keys(n);
+    for (int& key : keys) key = dist(rng);
+    return keys;
+}
+
+std::vector<Record> records(const std::vector<int>& keys) {
+    std::vector<Record> out(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        out[i] = Record{keys[i], static_cast<int>(i)};
+    }
+    return out;
+}
+
+std::vector<std::string> taggedStrings(const std::vector<int>& keys) {
+    std::vector<std::string> out(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        out[i] = std::string(1, static_cast<char>('a' + keys[i] % 26)) + std::to_string(i);
+    }
+    return out;
+}
+
+bool sameRecords(const std::vector<Record>& a, const std::vector<Record>& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const Record& x, const Record& y) {
+        return x.key == y.key && x.index == y.index;
+    });
+}
+
+std::string label(const std::string& sortName, const std::string& what, size_t n) {
+    return sortName + ": " + what + ", n=" + std::to_string(n);
+}
+
+// Calls visit(name, stable, quadratic, sort) for every comparison sort, where
+// sort(first, last, comp) runs it on a vector range
+template <typename Visitor>
+void forEachSort(ThreadPool& pool, Visitor visit) {
+    visit("insertionSort", true, true, [](auto first, auto last, auto comp) {
+        sorting::insertionSort(first, last, comp);
+    });
+    visit("bubbleSort", true, true, [](auto first, auto last, auto comp) {
+        sorting::bubbleSort(first, last, comp);
+    });
+    visit("cocktailSort", true, true, [](auto first, auto last, auto comp) {
+        sorting::cocktailSort(first, last, comp);
+    });
+    visit("selectionSort", false, true, [](auto first, auto last, auto comp) {
+        sorting::selectionSort(first, last, comp);
+    });
+    visit("combSort", false, false, [](auto first, auto last, auto comp) {
+        sorting::combSort(first, last, comp);
+    });
+    visit("mergeSort", true, false, [](auto first, auto last, auto comp) {
+        sorting::mergeSort(first, last, comp);
+    });
+    visit("mergeSort (workspace)", true, false, [](auto first, auto last, auto comp) {
+        // A workspace too small for the input has to grow
+        sorting::SortWorkspace<sorting::ValueType<decltype(first)>> workspace(1);
+        sorting::mergeSort(first, last, workspace, comp);
+    });
+    visit("heapSort", false, false, [](auto first, auto last, auto comp) {
+        sorting::heapSort(first, last, comp);
+    });
+    visit("dAryHeapSort<3>", false, false, [](auto first, auto last, auto comp) {
+        sorting::dAryHeapSort<3>(first, last, comp);
+    });
+    visit("dAryHeapSort<4>", false, false, [](auto first, auto last, auto comp) {
+        sorting::dAryHeapSort<4>(first, last, comp);
+    });
+    visit("dAryHeapSort<8>", false, false, [](auto first, auto last, auto comp) {
+        sorting::dAryHeapSort<8>(first, last, comp);
+    });
+    visit("quickSort", false, false, [](auto first, auto last, auto comp) {
+        sorting::quickSort(first, last, comp);
+    });
+    visit("pdqSort", false, false, [](auto first, auto last, auto comp) {
+        sorting::pdqSort(first, last, comp);
+    });
+    visit("timSort", true, false, [](auto first, auto last, auto comp) {
+        sorting::timSort(first, last, comp);
+    });
+    visit("timSort (workspace)", true, false, [](auto first, auto last, auto comp) {
+        sorting::SortWorkspace<sorting::ValueType<decltype(first)>> workspace(1);
+        sorting::timSort(first, last, workspace, comp);
+    });
+    visit("tournamentSort", true, false, [](auto first, auto last, auto comp) {
+        sorting::tournamentSort(first, last, comp);
+    });
+    visit("librarySort", true, false, [](auto first, auto last, auto comp) {
+        sorting::librarySort(first, last, comp);
+    });
+    visit("parallelMergeSort", true, false, [&pool](auto first, auto last, auto comp) {
+        sorting::parallelMergeSort(first, last, pool, comp);
+    });
+    visit("parallelQuickSort", false, false, [&pool](auto first, auto last, auto comp) {
+        sorting::parallelQuickSort(first, last, pool, comp);
+    });
+}
+
+// Sort a copy of input with sort and with std::stable_sort, and compare.
+// Unstable sorts are compared by key only.
+template <typename T, typename Sort, typename Compare, typename Equal>
+void checkAgainstStdSort(const std::string& what, const std::vector<T>& input, Sort& sort,
+                         Compare comp, Equal equal) {
+    std::vector<T> expected = input;
+    std::stable_sort(expected.begin(), expected.end(), comp);
+    std::vector<T> actual = input;
+    sort(actual.begin(), actual.end(), comp);
+    check(std::equal(actual.begin(), actual.end(), expected.begin(), expected.end(), equal), what);
+}
+
+void testComparisonSorts(ThreadPool& pool) {
+    forEachSort(pool, [](const std::string& name, bool stable, bool quadratic, auto sort) {
+        auto sameInt = [](int a, int b) { return a == b; };
+        auto sameKey = [](const Record& a, const Record& b) { return a.key == b.key; };
+        auto sameString = [](const std::string& a, const std::string& b) { return a == b; };
+        auto sameLetter = [](const std::string& a, const std::string& b) { return a[0] == b[0]; };
+
+        // Every generated data set, ascending and descending
+        size_t n = quadratic ? QUADRATIC_SIZE : LARGE_SIZE;
+        for (DataSetType type : allDataSetTypes()) {
+            std::vector<int> data = generateDataSet(type, n, 42);
+            checkAgainstStdSort(label(name, dataSetName(type), n), data, sort, std::less<int>(), sameInt);
+            checkAgainstStdSort(label(name, dataSetName(type) + " descending", n), data, sort,
+                                std::greater<int>(), sameInt);
+        }
+
+        for (size_t size : EDGE_SIZES) {
+            std::vector<int> keys = randomKeys(size, 8, size);
+            checkAgainstStdSort(label(name, "edge size", size), keys, sort, std::less<int>(), sameInt);
+            checkAgainstStdSort(label(name, "edge size descending", size), keys, sort,
+                                std::greater<int>(), sameInt);
+            std::vector<int> sorted = keys;
+            std::sort(sorted.begin(), sorted.end());
+            checkAgainstStdSort(label(name, "edge size sorted", size), sorted, sort, std::less<int>(), sameInt);
+            checkAgainstStdSort(label(name, "edge size reversed", size), sorted, sort,
+                                std::greater<int>(), sameInt);
+        }
+
+        // Key types that are not int: records and strings, with many ties
+        for (size_t size : {size_t(0), size_t(1), size_t(2), size_t(33), size_t(65), n}) {
+            std::vector<int> keys = randomKeys(size, 16, size + 1);
+            std::vector<Record> recs = records(keys);
+            std::vector<std::string> strings = taggedStrings(keys);
+
+            if (stable) {
+                auto sameRecord = [](const Record& a, const Record& b) {
+                    return a.key == b.key && a.index == b.index;
+                };
+                checkAgainstStdSort(label(name, "stable records", size), recs, sort, ByKey(), sameRecord);
+                checkAgainstStdSort(label(name, "stable records descending", size), recs, sort,
+                                    ByKeyDescending(), sameRecord);
+                checkAgainstStdSort(label(name, "stable strings", size), strings, sort, ByFirstLetter(),
+                                    sameString);
+            } else {
+                checkAgainstStdSort(label(name, "records", size), recs, sort, ByKey(), sameKey);
+                checkAgainstStdSort(label(name, "records descending", size), recs, sort,
+                                    ByKeyDescending(), sameKey);
+                checkAgainstStdSort(label(name, "strings", size), strings, sort, ByFirstLetter(),
+                                    sameLetter);
+            }
+            checkAgainstStdSort(label(name, "strings", size), strings, sort, std::less<std::string>(),
+                                sameString);
+        }
+    });
+}
+
+// Integer keys at the ends of their range, where the sign bit flip matters
+template <typename T>
+std::vector<T> extremeKeys(size_t n, std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<T> dist(std::numeric_limits<T>::min(), std::numeric_limits<T>::max());
+    const T specials[] = {std::numeric_limits<T>::min(), std::numeric_limits<T>::max(), T(-1), T(0), T(1)};
+    std::vector<T> keys(n);
+    for (size_t i = 0; i < n; i++) {
+        keys[i] = i % 3 == 0 ? specials[(i / 3) % 5] : dist(rng);
+    }
+    return keys;
+}
+
+template <typename T, typename Sort>
+void checkRadix(const std::string& name, Sort sort) {
+    std::vector<size_t> sizes = EDGE_SIZES;
+    sizes.push_back(LARGE_SIZE);
+    for (size_t n : sizes) {
+        std::vector<T> data = extremeKeys<T>(n, n);
+        std::vector<T> expected = data;
+        std::sort(expected.begin(), expected.end());
+        sort(data.begin(), data.end());
+        check(data == expected, label(name, "extreme keys", n));
+    }
+}
+
+void testRadixSorts(ThreadPool& pool) {
+    for (DataSetType type : allDataSetTypes()) {
+        std::vector<int> data = generateDataSet(type, LARGE_SIZE, 7);
+        std::vector<int> expected = data;
+        std::sort(expected.begin(), expected.end());
+
+        auto run = [&](const std::string& name, auto sort) {
+            std::vector<int> actual = data;
+            sort(actual.begin(), actual.end());
+            check(actual == expected, label(name, dataSetName(type), LARGE_SIZE));
+        };
+        run("lsdRadixSort<8>", [](auto first, auto last) { sorting::lsdRadixSort<8>(first, last); });
+        run("lsdRadixSort<11>", [](auto first, auto last) { sorting::lsdRadixSort<11>(first, last); });
+        run("lsdRadixSort<16>", [](auto first, auto last) { sorting::lsdRadixSort<16>(first, last); });
+        run("msdRadixSort", [](auto first, auto last) { sorting::msdRadixSort(first, last); });
+        run("parallelLsdRadixSort<8>", [&pool](auto first, auto last) {
+            sorting::parallelLsdRadixSort<8>(first, last, pool);
+        });
+    }
+
+    checkRadix<int>("lsdRadixSort<8>", [](auto first, auto last) { sorting::lsdRadixSort<8>(first, last); });
+    checkRadix<int>("lsdRadixSort<11>", [](auto first, auto last) { sorting::lsdRadixSort<11>(first, last); });
+    checkRadix<int>("lsdRadixSort<16>", [](auto first, auto last) { sorting::lsdRadixSort<16>(first, last); });
+    checkRadix<int>("msdRadixSort", [](auto first, auto last) { sorting::msdRadixSort(first, last); });
+    checkRadix<int>("parallelLsdRadixSort<8>", [&pool](auto first, auto last) {
+        sorting::parallelLsdRadixSort<8>(first, last, pool);
+    });
+    checkRadix<std::int64_t>("lsdRadixSort<16> int64", [](auto first, auto last) {
+        sorting::lsdRadixSort<16>(first, last);
+    });
+    checkRadix<std::int64_t>("msdRadixSort int64", [](auto first, auto last) {
+        sorting::msdRadixSort(first, last);
+    });
+    checkRadix<unsigned>("lsdRadixSort<8> unsigned", [](auto first, auto last) {
+        sorting::lsdRadixSort<8>(first, last);
+    });
+}
+
+// Merge k sorted runs of records with mergeRuns; ties must come out in run
+// order, and within a run in input order
+void testMergeRuns() {
+    for (size_t k : {size_t(1), size_t(2), size_t(3), size_t(5), size_t(8)}) {
+        for (size_t runLength : {size_t(0), size_t(1), size_t(7), size_t(100)}) {
+            std::vector<std::vector<Record>> runs(k);
+            std::vector<Record> expected;
+            int index = 0;
+            for (size_t r = 0; r < k; r++) {
+                // Runs of different lengths, one of them empty when k > 2
+                size_t length = (k > 2 && r == 1) ? 0 : runLength + r;
+                std::vector<int> keys = randomKeys(length, 5, k * 100 + r);
+                std::sort(keys.begin(), keys.end());
+                runs[r] = records(keys);
+                for (Record& rec : runs[r]) rec.index = index++;
+                expected.insert(expected.end(), runs[r].begin(), runs[r].end());
+            }
+            std::stable_sort(expected.begin(), expected.end(), ByKey());
+
+            using It = std::vector<Record>::const_iterator;
+            std::vector<std::pair<It, It>> ranges;
+            for (const std::vector<Record>& run : runs) ranges.emplace_back(run.begin(), run.end());
+            std::vector<Record> merged(expected.size());
+            auto end = sorting::mergeRuns(ranges, merged.begin(), ByKey());
+
+            std::string what = "k=" + std::to_string(k) + ", run length " + std::to_string(runLength);
+            check(end == merged.end(), "mergeRuns: output end, " + what);
+            check(sameRecords(merged, expected), "mergeRuns: stable merge, " + what);
+
+            // The same merge through the tree itself, descending
+            std::vector<std::vector<Record>> reversed = runs;
+            std::vector<Record> expectedDescending;
+            for (std::vector<Record>& run : reversed) {
+                std::stable_sort(run.begin(), run.end(), ByKeyDescending());
+                expectedDescending.insert(expectedDescending.end(), run.begin(), run.end());
+            }
+            std::stable_sort(expectedDescending.begin(), expectedDescending.end(), ByKeyDescending());
+            ranges.clear();
+            for (const std::vector<Record>& run : reversed) ranges.emplace_back(run.begin(), run.end());
+            sorting::LoserTree<It, ByKeyDescending> tree(ranges);
+            std::vector<Record> popped;
+            while (!tree.empty()) {
+                popped.push_back(tree.top());
+                tree.pop();
+            }
+            check(sameRecords(popped, expectedDescending), "LoserTree: stable descending, " + what);
+        }
+    }
+}
+
+// The heap sorts align sibling groups to cache lines by setting aside the
+// smallest few elements, a different number for every start address
+void testHeapLayouts() {
+    std::vector<int> data = generateDataSet(DataSetType::UNIFORM, LARGE_SIZE + 8, 3);
+    for (size_t offset = 0; offset < 8; offset++) {
+        std::vector<int> expected(data.begin() + offset, data.end());
+        std::sort(expected.begin(), expected.end());
+
+        auto run = [&](const std::string& name, auto sort) {
+            std::vector<int> actual = data;
+            sort(actual.data() + offset, actual.data() + actual.size());
+            check(std::equal(expected.begin(), expected.end(), actual.begin() + offset),
+                  label(name, "start offset " + std::to_string(offset), expected.size()));
+        };
+        run("heapSort", [](int* first, int* last) { sorting::heapSort(first, last); });
+        run("dAryHeapSort<4>", [](int* first, int* last) { sorting::dAryHeapSort<4>(first, last); });
+        run("dAryHeapSort<8>", [](int* first, int* last) { sorting::dAryHeapSort<8>(first, last); });
+    }
+
+    for (int arity : {2, 4, 8}) {
+        HeapSort sorter(arity);
+        std::string name = sorter.getName();
+        check(name == (arity == 2 ? "Heap Sort" : std::to_string(arity) + "-ary Heap Sort"),
+              "HeapSort(" + std::to_string(arity) + "): name " + name);
+        for (DataSetType type : {DataSetType::RANDOM, DataSetType::QUICKSORT_KILLER}) {
+            std::vector<int> actual = generateDataSet(type, LARGE_SIZE, 5);
+            std::vector<int> expected = actual;
+            std::sort(expected.begin(), expected.end());
+            sorter.sort(actual);
+            check(actual == expected, label(name, dataSetName(type), LARGE_SIZE));
+        }
+    }
+
+    bool threw = false;
+    try {
+        HeapSort sorter(3);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    check(threw, "HeapSort(3): rejected");
+}
+
+void testSimdKernels() {
+    for (std::ptrdiff_t n = 0; n <= sorting::simd::MAX_NETWORK_SIZE + 1; n++) {
+        std::vector<int> data = extremeKeys<int>(static_cast<size_t>(n), n);
+        std::vector<int> expected = data;
+        std::sort(expected.begin(), expected.end());
+        bool ran = sorting::simd::sortNetwork(data.data(), n);
+        bool expectRun = n <= sorting::simd::MAX_NETWORK_SIZE &&
+                         sorting::simd::activeIsa() != sorting::simd::IsaLevel::SCALAR;
+        check(ran == expectRun, label("sortNetwork", "availability", n));
+        if (ran) check(data == expected, label("sortNetwork", "extreme keys", n));
+    }
+
+    bool avx2 = sorting::simd::activeIsa() == sorting::simd::IsaLevel::AVX2;
+    for (std::ptrdiff_t na : {0, 7, 8, 9, 16, 31, 100, 1000}) {
+        for (std::ptrdiff_t nb : {0, 7, 8, 17, 64, 999}) {
+            std::vector<int> a = extremeKeys<int>(na, na * 31 + nb);
+            std::vector<int> b = extremeKeys<int>(nb, nb * 17 + na);
+            std::sort(a.begin(), a.end());
+            std::sort(b.begin(), b.end());
+            std::vector<int> expected(na + nb);
+            std::merge(a.begin(), a.end(), b.begin(), b.end(), expected.begin());
+
+            std::string what = "na=" + std::to_string(na) + ", nb=" + std::to_string(nb);
+            bool expectRun = avx2 && na >= 8 && nb >= 8;
+            std::vector<int> out(na + nb);
+            bool ran = sorting::simd::mergeInts(a.data(), na, b.data(), nb, out.data());
+            check(ran == expectRun, "mergeInts: availability, " + what);
+            if (ran) check(out == expected, "mergeInts: " + what);
+
+            std::vector<int> back(na + nb);
+            ran = sorting::simd::mergeIntsBackward(a.data(), na, b.data(), nb, back.data());
+            check(ran == expectRun, "mergeIntsBackward: availability, " + what);
+            if (ran) check(back == expected, "mergeIntsBackward: " + what);
+        }
+    }
+}
+
+// Key/index pairs with many equal keys, merged by mergeKeyIndex and by
+// std::merge on the packed values. The kernel either declines, writing
+// nothing, or gives the same output, equal keys in index order.
+void testKeyIndexMerge() {
+    using sorting::simd::keyOf;
+    using sorting::simd::indexOf;
+
+    bool avx2 = sorting::simd::activeIsa() == sorting::simd::IsaLevel::AVX2;
+    std::string isa = sorting::simd::isaName(sorting::simd::activeIsa());
+    for (std::ptrdiff_t na : {0, 3, 4, 5, 8, 9, 17, 100, 1000}) {
+        for (std::ptrdiff_t nb : {0, 3, 4, 7, 8, 33, 999}) {
+            std::vector<int> keysA = randomKeys(na, 6, na * 13 + nb);
+            std::vector<int> keysB = randomKeys(nb, 6, nb * 7 + na);
+            std::sort(keysA.begin(), keysA.end());
+            std::sort(keysB.begin(), keysB.end());
+
+            // Keys -3..2, so negative keys tie too; b's indices follow a's
+            std::vector<std::int64_t> a(na), b(nb);
+            std::vector<Record> expectedRecords;
+            for (std::ptrdiff_t i = 0; i < na; i++) {
+                a[i] = sorting::simd::packKeyIndex(keysA[i] - 3, static_cast<std::uint32_t>(i));
+                expectedRecords.push_back(Record{keysA[i] - 3, static_cast<int>(i)});
+            }
+            for (std::ptrdiff_t i = 0; i < nb; i++) {
+                b[i] = sorting::simd::packKeyIndex(keysB[i] - 3, static_cast<std::uint32_t>(na + i));
+                expectedRecords.push_back(Record{keysB[i] - 3, static_cast<int>(na + i)});
+            }
+            std::stable_sort(expectedRecords.begin(), expectedRecords.end(), ByKey());
+            std::vector<std::int64_t> expected(na + nb);
+            std::merge(a.begin(), a.end(), b.begin(), b.end(), expected.begin());
+
+            std::string what = isa + ", na=" + std::to_string(na) + ", nb=" + std::to_string(nb);
+            const std::int64_t untouched = INT64_MIN;
+            std::vector<std::int64_t> out(na + nb, untouched);
+            bool ran = sorting::simd::mergeKeyIndex(a.data(), na, b.data(), nb, out.data());
+            check(ran == (avx2 && na >= 4 && nb >= 4), "mergeKeyIndex: availability, " + what);
+            if (!ran) {
+                check(std::count(out.begin(), out.end(), untouched) == na + nb,
+                      "mergeKeyIndex: declined without writing, " + what);
+                continue;
+            }
+            check(out == expected, "mergeKeyIndex: matches std::merge, " + what);
+
+            std::vector<Record> merged(out.size());
+            for (size_t i = 0; i < out.size(); i++) {
+                merged[i] = Record{keyOf(out[i]), static_cast<int>(indexOf(out[i]))};
+            }
+            check(sameRecords(merged, expectedRecords), "mergeKeyIndex: equal keys in index order, " + what);
+        }
+    }
+}
+
+// Every instruction set level up to the detected one: the kernels and the
+// sorts that call them, so the scalar and SSE4.1 fallbacks run here too
+void testIsaLevels(ThreadPool& pool) {
+    using sorting::simd::IsaLevel;
+    for (IsaLevel level : {IsaLevel::SCALAR, IsaLevel::SSE41, IsaLevel::AVX2}) {
+        sorting::simd::limitIsa(level);
+        if (sorting::simd::activeIsa() != level) continue;
+        std::string isa = sorting::simd::isaName(level);
+
+        testSimdKernels();
+        testKeyIndexMerge();
+        forEachSort(pool, [&](const std::string& name, bool, bool quadratic, auto sort) {
+            if (quadratic) return;
+            std::vector<size_t> sizes = EDGE_SIZES;
+            sizes.push_back(LARGE_SIZE);
+            for (size_t n : sizes) {
+                std::vector<int> data = generateDataSet(DataSetType::UNIFORM, n, n);
+                checkAgainstStdSort(label(name, isa, n), data, sort, std::less<int>(),
+                                    [](int a, int b) { return a == b; });
+            }
+        });
+    }
+    sorting::simd::limitIsa(IsaLevel::AVX2);
+}
+
+} // namespace
+
+int main() {
+    ThreadPool pool(4);
+
+    testComparisonSorts(pool);
+    testRadixSorts(pool);
+    testMergeRuns();
+    testHeapLayouts();
+    testIsaLevels(pool);
+
+    std::cout << checks - failures << " of " << checks << " checks passed (SIMD: "
+              << sorting::simd::isaName(sorting::simd::detectIsa()) << ")\n";
+    return failures == 0 ? 0 : 1;
+}